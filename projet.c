@@ -1,8 +1,24 @@
+#define _GNU_SOURCE     //memmem
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <math.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 #define max(a, b) ((a) > (b) ? (a) : (b))
+#define min(a, b) ((a) < (b) ? (a) : (b))
 
 typedef struct vertex
 {
@@ -26,11 +42,12 @@ typedef struct arete
     int faceA;
 } Arete;
 
-typedef struct areted
+typedef struct pairesd
 {
-    int f1, f2;
-    struct areted *next;
-} AreteD;
+    int *f;         //Arêtes duales dans l'ordre où le moteur les trouve : (f[2k], f[2k + 1])
+    int num;        //Nombre de paires
+    int cap;        //Capacité, en paires
+} PairesD;
 
 typedef struct areteavl
 {
@@ -41,11 +58,87 @@ typedef struct areteavl
     int hauteur;
 } AreteAVL;
 
+typedef struct arena
+{
+    char **blocs;           //Blocs alloués, le dernier est le bloc courant
+    size_t *tailles;
+    int numBlocs, capBlocs;
+    size_t pos;             //Position dans le bloc courant
+    size_t reserve;         //Octets des blocs
+    long long allocations;  //Compteurs cumulés, gardés après libération
+    size_t octets;
+    size_t comptes;         //Part de octets déjà reportée dans le cumul du profilage
+} Arena;
+
 typedef struct centoideC
 {
     int distance;
 } CentoideC;
 
+typedef struct niveaubfs
+{
+    int niveau;
+    int ascendant;          //Sens du niveau : 1 ascendant (bottom-up), 0 descendant (top-down)
+    long long frontiere;    //Faces de la frontière au début du niveau
+    long long decouvertes;  //Faces découvertes pendant le niveau
+    long long examinees;    //Arêtes examinées
+    double temps;
+} NiveauBFS;
+
+typedef struct aretecle
+{
+    uint64_t cle;  //(num1, num2) regroupés, voir cleArete
+    int faceA;     //-1 si la case de la table de hachage est vide
+} AreteCle;
+
+typedef struct areteidx
+{
+    uint64_t cle;
+    int indice;    //Position de l'arête dans le tableau d'origine
+} AreteIdx;
+
+typedef struct dualcsr
+{
+    int numF;           //Nombre de faces (sommets du graphe dual)
+    int numAretes;      //Nombre d'arêtes duales
+    int *debut;         //Voisins de la face f : voisins[debut[f]] ... voisins[debut[f + 1] - 1]
+    int *voisins;       //Chaque arête duale y apparaît deux fois, une fois par extrémité
+    int graine;         //Point de départ du parcours (première face de la dernière paire trouvée)
+} DualCSR;
+
+typedef struct enteteCache
+{
+    char magie[8];          //"SDACACHE"
+    uint32_t version;
+    uint32_t tailleEntete;
+    uint64_t tailleSource;  //Taille et date du .obj, pour détecter un cache périmé
+    int64_t dateSource;
+    int32_t numV, numF;
+    int32_t numAretes;      //-1 si le graphe dual n'est pas stocké
+    int32_t graine;
+    char moteur[20];        //Moteur qui a produit le graphe dual (la graine en dépend)
+    uint64_t offsetV, offsetF, offsetDebut, offsetVoisins;
+    uint64_t tailleFichier;
+    uint64_t somme;         //Somme de contrôle du fichier entier, ce champ compté à zéro
+} EnteteCache;
+
+typedef struct cache
+{
+    void *data;             //Projection du fichier
+    size_t taille;
+    Vertex *v;
+    Face *f;
+    int numV, numF;
+    DualCSR dual;           //dual.debut vaut NULL si le graphe dual est absent
+} Cache;
+
+typedef struct moteur
+{
+    const char *nom;
+    void (*tri)(Arete *, int, PairesD *);
+    int quadratique;        //Coût quadratique mesuré : le banc d'essai l'ignore sur les gros maillages
+} Moteur;
+
 
 /**
  * @brief   Lit le fichier .obj
@@ -107,735 +200,8620 @@ int readObj(const char *filename, Vertex **vertex, int *numV, Face **face, int *
 }
 
 
+int nbThreads = 0;    //Nombre de threads (option -j), 0 : un par cœur
+__thread int travailleurLot = 0;    //1 dans un travailleur de --lot : les moteurs restent sur un thread
+
+
 /**
- * @brief   Écrit le fichier .obj
- * @param   filename Nom du fichier (par exemple test.obj)
- * @param   vertex   Tableau des sommets
- * @param   numV     Nombre de sommets
- * @param   face     Tableau des faces
- * @param   numF     Nombre de faces
- * @return  1 en cas de succès, 0 en cas d'échec
+ * @brief   Temps écoulé (horloge murale), à utiliser quand plusieurs threads travaillent
+ * @return  Temps en secondes
  */
-int writeOBJ(const char *filename, Vertex *vertex, int numV, Face *face, int numF)
+double tempsMur(void)
 {
-    FILE *file = fopen(filename, "w");
-    if (!file)
-    {
-        printf("Impossible d'ouvrir le fichier .obj\n");
-        return 0;
-    }
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
 
-    for (int i = 0; i < numV; i++)
-    {
-        fprintf(file, "v %f %f %f\n", vertex[i].a, vertex[i].b, vertex[i].c);
-    }
-    for (int a = 0; a < numF; a++)
-    {
-        fprintf(file, "f %d %d %d\n", face[a].v1, face[a].v2, face[a].v3);
-    }
 
-    fclose(file);
-    return 1;
+// profilage
+
+typedef struct phase
+{
+    const char *nom;
+    double mur;             //Temps mural (s)
+    double cpu;             //Temps CPU du processus, tous threads (s)
+    long rssMax;            //Pic de mémoire résidente pendant la phase (Ko)
+    long long octets;       //Octets alloués pendant la phase (gros tableaux et arènes), libérations non déduites
+    long long materiel[3];  //Cycles, instructions, défauts de cache LLC (-1 si indisponible)
+    int ouverte;            //Phase en cours : son pic suit les remises à zéro des phases imbriquées
+} Phase;
+
+int profilage = 0;                  //Option --profile
+const char *profilSortie = NULL;    //Fichier JSON, NULL : tableau sur la sortie standard
+Phase *phases = NULL;               //Agrandi à la demande : --graines ouvre une phase d'écriture par graine
+int numPhases = 0, capPhases = 0;
+int picParPhase = 1;                //0 si /proc/self/clear_refs est refusé : pic du processus depuis son début
+int compteursMateriels[3] = {-1, -1, -1};   //Descripteurs perf_event
+long long octetsAlloues = 0;        //Cumul des allocations comptées, tous threads (mis à jour atomiquement)
+
+//Compteurs algorithmiques, mis à jour même sans --profile (un incrément ne coûte rien).
+//Propres à chaque thread : les travailleurs de --lot font tourner les moteurs en même temps.
+__thread long long compteurComparaisons = 0;     //Appels à estSuperieureA
+__thread long long compteurRotations = 0;        //Rotations rotaD et rotaG
+__thread long long compteurNiveauxBFS = 0;       //Niveaux des parcours en largeur
+
+static const char *nomsMateriels[3] = {"cycles", "instructions", "llc_defauts"};
+
+static double tempsCPU(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static long long lireCompteur(int i)
+{
+    long long valeur;
+    if (compteursMateriels[i] < 0 || read(compteursMateriels[i], &valeur, sizeof(valeur)) != sizeof(valeur))
+        return -1;
+    return valeur;
 }
 
 
 /**
- * @brief   Calcule les centroïdes des faces
- * @param   vertex   Tableau des sommets
- * @param   numV     Nombre de sommets
- * @param   face     Tableau des faces
- * @param   numF     Nombre de faces
- * @return  Tableau des centroïdes
+ * @brief   Ajoute taille octets au cumul des allocations (rapport --profile).
  */
-Centoide *calculateCentroids(Vertex *vertex, int numV, Face *face, int numF)
+static inline void compterAllocation(size_t taille)
 {
-    Centoide *centroids = malloc(sizeof(Centoide) * numF);
-    for (int i = 0; i < numF; i++)
-    {
-        centroids[i].centre.a = (vertex[face[i].v1 - 1].a + vertex[face[i].v2 - 1].a + vertex[face[i].v3 - 1].a) / 3.0;
-        centroids[i].centre.b = (vertex[face[i].v1 - 1].b + vertex[face[i].v2 - 1].b + vertex[face[i].v3 - 1].b) / 3.0;
-        centroids[i].centre.c = (vertex[face[i].v1 - 1].c + vertex[face[i].v2 - 1].c + vertex[face[i].v3 - 1].c) / 3.0;
-    }
-    return centroids;
+    __atomic_fetch_add(&octetsAlloues, (long long)taille, __ATOMIC_RELAXED);
 }
 
 
 /**
- * @brief   Généralise les arêtes à partir des faces
- * @param   f        Tableau des faces
- * @param   numF     Nombre de faces
- * @param   v        Tableau des sommets
- * @return  Tableau des arêtes généralisées
+ * @brief   malloc compté : à utiliser pour les tableaux proportionnels au maillage.
  */
-Arete *generalise(Face *f, int numF, Vertex *v)
+void *allouer(size_t taille)
 {
-    int numEdges = numF * 3;    //Un face a 3 arêtes 
-    Arete *aretes = (Arete *)malloc(numEdges * sizeof(Arete));
-
-    for (int i = 0; i < numF; i++)
-    {
-        int v1Index = f[i].v1;    //index de sommets
-        int v2Index = f[i].v2;
-        int v3Index = f[i].v3;
-
-        // Vertex v1 = v[v1Index];      L'idée initiale
-        // Vertex v2 = v[v2Index];
-        // Vertex v3 = v[v3Index];
-
-        // aretes[i * 3].sommet1 = v1;
-        // aretes[i * 3].sommet2 = v2;
-        if (v1Index < v2Index)     //Toujours placer les plus petits en premier pour faciliter la comparaison et le tri.
-        {
-            aretes[i * 3].num1 = v1Index;   //En utilisant les positions des trois sommets dans le tableau de sommets à l'intérieur de la face, 
-            aretes[i * 3].num2 = v2Index;   //attribuez des numéros aux deux sommets de l'arête.
-        }
-        else
-        {
-            aretes[i * 3].num1 = v2Index;
-            aretes[i * 3].num2 = v1Index;
-        }
-        aretes[i * 3].faceA = i;    //Face associe
-
-        // aretes[i * 3 + 1].sommet1 = v2;
-        // aretes[i * 3 + 1].sommet2 = v3;
-        if (v2Index < v3Index)
-        {
-            aretes[i * 3 + 1].num1 = v2Index;
-            aretes[i * 3 + 1].num2 = v3Index;
-        }
-        else
-        {
-            aretes[i * 3 + 1].num1 = v3Index;
-            aretes[i * 3 + 1].num2 = v2Index;
-        }
-        aretes[i * 3 + 1].faceA = i;
-
-        // aretes[i * 3 + 2].sommet1 = v3;
-        // aretes[i * 3 + 2].sommet2 = v1;
-        if (v1Index < v3Index)
-        {
-            aretes[i * 3 + 2].num1 = v1Index;
-            aretes[i * 3 + 2].num2 = v3Index;
-        }
-        else
-        {
-            aretes[i * 3 + 2].num1 = v3Index;
-            aretes[i * 3 + 2].num2 = v1Index;
-        }
-        aretes[i * 3 + 2].faceA = i;    
-    }
-
-    return aretes;
+    compterAllocation(taille);
+    return malloc(taille);
 }
 
 
 /**
- * @brief   Vérifie si deux arêtes sont équivalentes
- * @param   a1       Première arête
- * @param   a2       Deuxième arête
- * @return  1 si équivalentes, 0 sinon
+ * @brief   calloc compté.
  */
-int sontEquivalentes(Arete a1, Arete a2)
+void *allouerZero(size_t nombre, size_t taille)
 {
-    // if ((a1.sommet1.a == a2.sommet1.a && a1.sommet1.b == a2.sommet1.b && a1.sommet1.c == a2.sommet1.c) &&
-    //     (a1.sommet2.a == a2.sommet2.a && a1.sommet2.b == a2.sommet2.b && a1.sommet2.c == a2.sommet2.c))
-    // {
-    //     return 1;
-    // }
-
-    // if ((a1.sommet1.a == a2.sommet2.a && a1.sommet1.b == a2.sommet2.b && a1.sommet1.c == a2.sommet2.c) &&
-    //     (a1.sommet2.a == a2.sommet1.a && a1.sommet2.b == a2.sommet1.b && a1.sommet2.c == a2.sommet1.c))
-    // {
-    //     return 1;
-    // }
-
-    if ((a1.num1 == a2.num1) && (a1.num2 == a2.num2))  //Si deux sommets de arête1 = arête2, deux arête sont equivalent
-        return 1;
-    return 0;
+    compterAllocation(nombre * taille);
+    return calloc(nombre, taille);
 }
 
 
 /**
- * @brief   Compare deux arêtes pour déterminer si l'arête 1 est supérieure à l'arête 2.
- *
- * La comparaison est basée sur les indices des sommets de l'arête.
- * Si les numéros des sommets sont égaux, la fonction compare les numéros des autres sommets.
- *
- * @param   arete1 Première arête
- * @param   arete2 Deuxième arête
- * @return  Un entier négatif si arete1 est inférieure à arete2,
- *          un entier positif si arete1 est supérieure à arete2,
- *          et zéro si les arêtes sont équivalentes.
+ * @brief   realloc compté : seul l'agrandissement est ajouté au cumul.
+ * @param   p       Zone actuelle (ou NULL)
+ * @param   avant   Taille actuelle de la zone en octets
+ * @param   taille  Nouvelle taille en octets
  */
-int estSuperieureA(Arete arete1, Arete arete2)
+void *reallouer(void *p, size_t avant, size_t taille)
 {
-    if (arete1.num1 == arete2.num1)
-        return arete1.num2 - arete2.num2;
-    return arete1.num1 - arete2.num1;
+    if (taille > avant)
+        compterAllocation(taille - avant);
+    return realloc(p, taille);
 }
 
 
 /**
- * @brief   Crée une nouvelle arête dans la liste des arêtes équivalentes.
- * @param   f1 Numéro de la première face
- * @param   f2 Numéro de la deuxième face
- * @return  Un pointeur vers la nouvelle arête crée.
+ * @brief   Lit le pic de mémoire résidente (VmHWM) depuis la dernière remise à zéro.
+ * @return  Pic en Ko, -1 si /proc/self/status est illisible
  */
-AreteD *newareted(int f1, int f2)
+static long lirePicRSS(void)
 {
-    AreteD *newAreteD = malloc(sizeof(AreteD));
-    newAreteD->f1 = f1;
-    newAreteD->f2 = f2;
-    newAreteD->next = NULL;
-    return newAreteD;
+    FILE *f = fopen("/proc/self/status", "r");
+    if (f == NULL)
+        return -1;
+    char ligne[256];
+    long pic = -1;
+    while (fgets(ligne, sizeof(ligne), f))
+    {
+        if (sscanf(ligne, "VmHWM: %ld", &pic) == 1)
+            break;
+    }
+    fclose(f);
+    return pic;
 }
 
 
-
-// tri selection
-
 /**
- * @brief   Trie les arêtes par sélection
- * @param   aretes   Tableau des arêtes
- * @param   numEdges Nombre d'arêtes
- * @return  Liste des arêtes équivalentes
+ * @brief   Reporte le pic courant sur toutes les phases ouvertes, puis le remet à la mémoire
+ *          résidente actuelle (écriture de "5" dans /proc/self/clear_refs) pour que la phase
+ *          suivante mesure son propre pic.
+ * @param   remettre    1 pour remettre le pic à zéro après le report
  */
-AreteD *triSelection(Arete *aretes, int numEdges)
+static void reporterPicRSS(int remettre)
 {
-    AreteD *equivalentEdgesList = NULL;
-
-    for (int i = 0; i < numEdges - 1; i++)
+    long pic;
+    if (picParPhase)
+        pic = lirePicRSS();
+    else
     {
-        int minIndex = i;
-
-        for (int j = i + 1; j < numEdges; j++)
-        {
-            if (estSuperieureA(aretes[j], aretes[minIndex]) < 0)
-            {
-                minIndex = j;
-            }
-        }
-
-        Arete temp = aretes[i];
-        aretes[i] = aretes[minIndex];
-        aretes[minIndex] = temp;
+        struct rusage ru;
+        getrusage(RUSAGE_SELF, &ru);
+        pic = ru.ru_maxrss;
     }
-
-    for (int i = 0; i < numEdges - 1; i++)
+    for (int i = 0; i < numPhases; i++)
     {
-        // printf("%d 1: %d %d    2: %d %d\n", i, aretes[i].num1,aretes[i].num2, aretes[i+1].num1,aretes[i+1].num2);
-        if (sontEquivalentes(aretes[i], aretes[i + 1]))
-        {
-            AreteD *newAreteD = newareted(aretes[i].faceA, aretes[i + 1].faceA);  //Crée une nouvelle arête avec les numéros de faces fournies
-            newAreteD->next = equivalentEdgesList;   //Ajoute la nouvelle arête en tête de la liste des arêtes équivalentes
-            equivalentEdgesList = newAreteD;
-        }
+        if (phases[i].ouverte && pic > phases[i].rssMax)
+            phases[i].rssMax = pic;
     }
-
-    return equivalentEdgesList;
+    if (!remettre || !picParPhase)
+        return;
+    int fd = open("/proc/self/clear_refs", O_WRONLY);
+    if (fd < 0 || write(fd, "5", 1) != 1)
+        picParPhase = 0;
+    if (fd >= 0)
+        close(fd);
 }
 
 
-// tas sort
-
 /**
- * @brief   Réorganise le tableau en tas à partir de l'indice spécifié.
- *
- * @param   aretes  Tableau d'arêtes
- * @param   n       Taille du tableau
- * @param   i       Indice à partir duquel réorganiser le tableau en tas
+ * @brief   Ouvre les compteurs matériels (cycles, instructions, défauts LLC) avec perf_event_open.
+ *          Ils comptent le processus et les threads créés ensuite. Sans droits ou sans support
+ *          du noyau, les colonnes correspondantes sont simplement absentes du rapport.
  */
-void heapify(Arete *aretes, int n, int i)
+void ouvrirCompteursMateriels(void)
 {
-    int largest = i;    //Initialisation de l'indice du plus grand élément, du fils gauche et du fils droit
-    int left = 2 * i + 1;
-    int right = 2 * i + 2;
-
-    if (left < n && estSuperieureA(aretes[left], aretes[largest]) > 0)     //Vérifie si le fils gauche est plus grand que le plus grand élément actuel
-        largest = left;
+    uint64_t configs[3] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES};
+    for (int i = 0; i < 3; i++)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = configs[i];
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        compteursMateriels[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+}
 
-    if (right < n && estSuperieureA(aretes[right], aretes[largest]) > 0)
-        largest = right;
 
-    if (largest != i)   //Si le plus grand élément n'est pas à l'indice d'origine, échange les éléments et continue la réorganisation
+/**
+ * @brief   Ouvre une phase : mémorise l'état de départ des mesures et remet le pic de
+ *          mémoire résidente à zéro.
+ * @param   nom     Nom de la phase (chaîne statique)
+ * @return  Indice de la phase, -1 sans --profile
+ */
+int debutPhase(const char *nom)
+{
+    if (!profilage)
+        return -1;
+    if (numPhases == capPhases)
     {
-        Arete temp = aretes[i];
-        aretes[i] = aretes[largest];
-        aretes[largest] = temp;
-
-        heapify(aretes, n, largest);
+        capPhases = max(capPhases * 2, 16);
+        phases = realloc(phases, capPhases * sizeof(Phase));
     }
+    reporterPicRSS(1);
+    Phase *p = &phases[numPhases];
+    p->nom = nom;
+    p->mur = tempsMur();
+    p->cpu = tempsCPU();
+    p->rssMax = 0;
+    p->octets = __atomic_load_n(&octetsAlloues, __ATOMIC_RELAXED);
+    for (int i = 0; i < 3; i++)
+        p->materiel[i] = lireCompteur(i);
+    p->ouverte = 1;
+    return numPhases++;
 }
 
 
 /**
- * @brief   Construit un tas à partir du tableau d'arêtes.
- *
- * @param   aretes  Tableau d'arêtes
- * @param   n       Taille du tableau
+ * @brief   Ferme une phase : remplace l'état de départ par les écarts mesurés.
+ * @param   i   Indice rendu par debutPhase
  */
-void buildHeap(Arete *aretes, int n)
+void finPhase(int i)
 {
-    for (int i = n / 2 - 1; i >= 0; i--)   //Parcours du tableau d'arêtes à partir du milieu
-        heapify(aretes, n, i);
+    if (i < 0)
+        return;
+    Phase *p = &phases[i];
+    p->mur = tempsMur() - p->mur;
+    p->cpu = tempsCPU() - p->cpu;
+    p->octets = __atomic_load_n(&octetsAlloues, __ATOMIC_RELAXED) - p->octets;
+    for (int k = 0; k < 3; k++)
+    {
+        long long fin = lireCompteur(k);
+        p->materiel[k] = (fin < 0 || p->materiel[k] < 0) ? -1 : fin - p->materiel[k];
+    }
+    reporterPicRSS(0);
+    p->ouverte = 0;
 }
 
 
 /**
- * @brief   Trie les arêtes par tas
- * @param   aretes   Tableau des arêtes
- * @param   numEdges Nombre d'arêtes
- * @return  Liste des arêtes équivalentes
+ * @brief   Rapport de profilage : tableau par phase sur la sortie standard, ou JSON.
+ * @return  1 si le rapport a été écrit, 0 sinon
  */
-AreteD *triTas(Arete *aretes, int numEdges)
+int rapportProfil(void)
 {
-    AreteD *equivalentEdgesList = NULL;
-
-    buildHeap(aretes, numEdges); //Peut être placé dans la main
+    if (!profilage)
+        return 1;
+    int materiel = compteursMateriels[0] >= 0 || compteursMateriels[1] >= 0 || compteursMateriels[2] >= 0;
 
-    for (int i = numEdges - 1; i > 0; i--)
+    if (profilSortie == NULL)
     {
-        Arete temp = aretes[0];     //Échange l'élément le plus grand avec le dernier élément non trié
-        aretes[0] = aretes[i];
-        aretes[i] = temp;
-
-        heapify(aretes, i, 0);
+        printf("\n%-14s %10s %10s %12s %14s", "phase", "mur (s)", "cpu (s)", "pic rss (Ko)", "alloué (o)");
+        if (materiel)
+            printf(" %14s %14s %12s", "cycles", "instructions", "défauts LLC");
+        printf("\n");
+        for (int i = 0; i < numPhases; i++)
+        {
+            Phase *p = &phases[i];
+            printf("%-14s %10.6f %10.6f %12ld %14lld", p->nom, p->mur, p->cpu, p->rssMax, p->octets);
+            if (materiel)
+            {
+                for (int k = 0; k < 3; k++)
+                {
+                    if (p->materiel[k] < 0)
+                        printf(" %*s", k == 2 ? 12 : 14, "n/d");
+                    else
+                        printf(" %*lld", k == 2 ? 12 : 14, p->materiel[k]);
+                }
+            }
+            printf("\n");
+        }
+        if (!materiel)
+            printf("Compteurs matériels indisponibles (perf_event_open)\n");
+        if (!picParPhase)
+            printf("Pic rss : /proc/self/clear_refs refusé, pic du processus depuis son début\n");
+        printf("Comparaisons estSuperieureA : %lld\n", compteurComparaisons);
+        printf("Rotations AVL : %lld\n", compteurRotations);
+        printf("Niveaux BFS : %lld\n", compteurNiveauxBFS);
+        return 1;
     }
 
-    for (int k = 0; k < numEdges; k++)
+    FILE *out = fopen(profilSortie, "w");
+    if (out == NULL)
+    {
+        printf("Impossible d'écrire le profil %s\n", profilSortie);
+        return 0;
+    }
+    fprintf(out, "{\n  \"threads\": %d,\n  \"pic_par_phase\": %s,\n  \"phases\": [\n", nbThreads,
+            picParPhase ? "true" : "false");
+    for (int i = 0; i < numPhases; i++)
     {
-        if (sontEquivalentes(aretes[k], aretes[k + 1]))  //Les côtés identiques sont toujours adjacents.
+        Phase *p = &phases[i];
+        fprintf(out, "    {\"nom\": \"%s\", \"mur_s\": %.9f, \"cpu_s\": %.9f, \"rss_pic_ko\": %ld, \"octets_alloues\": %lld",
+                p->nom, p->mur, p->cpu, p->rssMax, p->octets);
+        for (int k = 0; k < 3; k++)
         {
-            AreteD *newAreteD = newareted(aretes[k].faceA, aretes[k + 1].faceA);
-            newAreteD->next = equivalentEdgesList;
-            equivalentEdgesList = newAreteD;
+            if (p->materiel[k] >= 0)
+                fprintf(out, ", \"%s\": %lld", nomsMateriels[k], p->materiel[k]);
         }
+        fprintf(out, "}%s\n", i + 1 < numPhases ? "," : "");
     }
-
-    return equivalentEdgesList;
+    fprintf(out, "  ],\n  \"compteurs\": {\"comparaisons\": %lld, \"rotations\": %lld, \"niveaux_bfs\": %lld}\n}\n",
+            compteurComparaisons, compteurRotations, compteurNiveauxBFS);
+    fclose(out);
+    printf("Profil écrit : %s\n", profilSortie);
+    return 1;
 }
 
 
-// AVL
+// lecture rapide
 
 /**
- * @brief   Calcule la hauteur de l'arbre AVL à partir du nœud spécifié.
- * @param   a   Nœud de l'arbre AVL
- * @return  La hauteur de l'arbre AVL
+ * @brief   Projette un fichier en mémoire (lecture seule).
+ * @param   filename Nom du fichier
+ * @param   taille   Taille du fichier en octets
+ * @return  Adresse du contenu, NULL en cas d'échec
  */
-int treeHeight(AreteAVL *a)
+const char *projeterFichier(const char *filename, size_t *taille)
 {
-    if (a == NULL)
-        return 0;
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return NULL;
 
-    int leftHeight = (a->left != NULL) ? a->left->hauteur : -1;
-    int rightHeight = (a->right != NULL) ? a->right->hauteur : -1;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size == 0)
+    {
+        close(fd);
+        return NULL;
+    }
 
-    return leftHeight - rightHeight;
-}
-
-
-/**
- * @brief   Calcule le facteur d'équilibre d'un nœud dans un arbre AVL.
- *
- * @param   a   Nœud de l'arbre AVL
- * @return  Le facteur d'équilibre du nœud (différence de hauteur entre le sous-arbre gauche et le sous-arbre droit)
- */
-int balanceP(AreteAVL *a)
-{
-    if (a == NULL)
-        return 0;
-    else if (a->left == NULL || a->right == NULL)
-        return 0;
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);    //La projection reste valide après la fermeture
+    if (data == MAP_FAILED)
+        return NULL;
 
-    return a->left->hauteur - a->right->hauteur;
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+    *taille = st.st_size;
+    return data;
 }
 
 
-/**
- * @brief   Effectue une rotation droite pour rééquilibrer un nœud dans un arbre AVL.
- *
- * @param   t   Nœud à rééquilibrer
- * @return  Nouveau nœud après la rotation
- */
-AreteAVL *rotaD(AreteAVL *t)
+static inline int estBlanc(char c)
 {
-    AreteAVL *left = t->left;
-
-    t->left = left->right;
-    left->right = t;
-
-    left->hauteur = max(treeHeight(left->left), treeHeight(left->right)) + 1;  //Met à jour les hauteurs après la rotation
-    t->hauteur = max(treeHeight(t->left), treeHeight(t->right)) + 1;
-
-    return left;
+    return c == ' ' || c == '\t' || c == '\r';
 }
 
-AreteAVL *rotaG(AreteAVL *t)   //Pareil comme avant
+static inline int estChiffre(char c)
 {
-    AreteAVL *right = t->right;
-
-    t->right = right->left;
-    right->left = t;
-
-    right->hauteur = max(treeHeight(right->left), treeHeight(right->right)) + 1;
-    t->hauteur = max(treeHeight(t->left), treeHeight(t->right)) + 1;
-
-    return right;
+    return c >= '0' && c <= '9';
 }
 
 
 /**
- * @brief   Rééquilibre un nœud dans un arbre AVL après une opération d'insertion ou de suppression.
+ * @brief   Lit un flottant sans sscanf ni locale.
  *
- * @param   a   Nœud à rééquilibrer
- * @return  Nouveau nœud après la rééquilibrage
+ * Chemin rapide : une mantisse d'au plus 2^24 et une puissance de 10 d'au plus 10 sont
+ * exactes en float, une seule multiplication ou division donne donc l'arrondi correct,
+ * le même que strtof. Les autres cas (beaucoup de chiffres, inf, nan...) passent par strtof.
+ *
+ * @param   pp      Position courante, avancée après le nombre
+ * @param   fin     Fin du texte
+ * @param   res     Valeur lue
+ * @return  1 si un nombre a été lu, 0 sinon
  */
-AreteAVL *treeRebalance(AreteAVL *a)
+int lireFloat(const char **pp, const char *fin, float *res)
 {
-    int factor = balanceP(a);    //Calcule le facteur d'équilibre du nœud
-    if (factor > 1)    //Si le facteur d'équilibre est supérieur à 1, un déséquilibre à gauche est détecté
+    static const float puissances[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+    const char *p = *pp;
+    while (p < fin && estBlanc(*p))
+        p++;
+    const char *debut = p;
+
+    int neg = 0;
+    if (p < fin && (*p == '-' || *p == '+'))
+        neg = (*p++ == '-');
+
+    uint64_t m = 0;
+    int exp10 = 0;
+    int chiffres = 0;
+    int exact = 1;    //0 si des chiffres significatifs ont été perdus
+    while (p < fin && estChiffre(*p))
     {
-        if (balanceP(a->left) >= 0) //LL
-            return rotaD(a);
-        else //LR
+        if (m < 100000000000000000ULL)
+            m = m * 10 + (*p - '0');
+        else
         {
-            a->left = rotaG(a->left);
-            return rotaD(a);
+            exp10++;
+            exact = 0;
         }
+        p++;
+        chiffres++;
     }
-    else if (factor < -1)
+    if (p < fin && *p == '.')
     {
-        if (balanceP(a->right) <= 0) //RR
-            return rotaG(a);
-        else //RL
+        p++;
+        while (p < fin && estChiffre(*p))
         {
-            a->right = rotaD(a->right);
-            return rotaG(a);
+            if (m < 100000000000000000ULL)
+            {
+                m = m * 10 + (*p - '0');
+                exp10--;
+            }
+            else
+                exact = 0;
+            p++;
+            chiffres++;
         }
     }
-    else 
+    if (chiffres > 0 && p < fin && (*p == 'e' || *p == 'E'))
     {
-        a->hauteur = max(treeHeight(a->left), treeHeight(a->right)) + 1;
-        return a;
+        const char *q = p + 1;
+        int negE = 0;
+        if (q < fin && (*q == '-' || *q == '+'))
+            negE = (*q++ == '-');
+        if (q < fin && estChiffre(*q))
+        {
+            int e = 0;
+            while (q < fin && estChiffre(*q))
+            {
+                if (e < 100000)
+                    e = e * 10 + (*q - '0');
+                q++;
+            }
+            exp10 += negE ? -e : e;
+            p = q;
+        }
+    }
+
+    if (chiffres > 0 && exact && m <= (1 << 24) && exp10 >= -10 && exp10 <= 10)
+    {
+        float x = (float)m;
+        x = (exp10 < 0) ? x / puissances[-exp10] : x * puissances[exp10];
+        *res = neg ? -x : x;
+        *pp = p;
+        return 1;
     }
+
+    char jeton[128];   //Cas rare : on laisse strtof faire l'arrondi
+    size_t len = 0;
+    while (debut + len < fin && len < sizeof(jeton) - 1 && !estBlanc(debut[len]) && debut[len] != '\n')
+        len++;
+    memcpy(jeton, debut, len);
+    jeton[len] = '\0';
+    char *finJeton;
+    *res = strtof(jeton, &finJeton);
+    if (finJeton == jeton)
+        return 0;
+    *pp = debut + (finJeton - jeton);
+    return 1;
 }
 
 
 /**
- * @brief   Vérifie si un nœud dans un arbre AVL est équivalent à nœud on veut insert.
+ * @brief   Lit un indice de sommet d'une face : a, a/b, a//c ou a/b/c (seul a est gardé).
  *
- * @param   a1      Nœud à vérifier
- * @param   num1    Premier numéro du sommet
- * @param   num2    Deuxième numéro du sommet
- * @return  1 si le nœud est équivalent au couple de numéros, sinon 0
+ * Un indice négatif est relatif au dernier sommet lu (-1 est le dernier) et devient absolu.
+ *
+ * @param   pp      Position courante, avancée après l'indice
+ * @param   fin     Fin du texte
+ * @param   numV    Nombre de sommets lus jusqu'ici
+ * @param   res     Indice (à partir de 1)
+ * @return  1 si un indice valide a été lu, 0 sinon
  */
-int sontEquivalentesA(AreteAVL *a1, int num1, int num2)
+int lireIndice(const char **pp, const char *fin, int numV, int *res)
 {
-    if ((a1->num1 == num1) && (a1->num2 == num2))
-        return 1;
-    return 0;
+    const char *p = *pp;
+    while (p < fin && estBlanc(*p))
+        p++;
+
+    int neg = 0;
+    if (p < fin && (*p == '-' || *p == '+'))
+        neg = (*p++ == '-');
+    if (p >= fin || !estChiffre(*p))
+        return 0;
+
+    long long n = 0;
+    while (p < fin && estChiffre(*p))
+    {
+        if (n < 10000000000LL)
+            n = n * 10 + (*p - '0');
+        p++;
+    }
+    while (p < fin && !estBlanc(*p) && *p != '\n')   //Saute /texture/normale
+        p++;
+    *pp = p;
+
+    if (neg)
+        n = numV - n + 1;
+    if (n < 1 || n > 2147483647LL)
+        return 0;
+    *res = (int)n;
+    return 1;
 }
 
-int estSuperieureAVL(AreteAVL *a, int num1, int num2)
+
+/**
+ * @brief   Donne le type d'une ligne .obj : 'v' (sommet), 'f' (face) ou 0 (à ignorer).
+ * @param   ligne    Début de la ligne
+ * @param   finLigne Fin de la ligne (sans le '\\n')
+ */
+static inline char typeLigne(const char *ligne, const char *finLigne)
 {
-    if (a->num1 == num1)
-        return a->num2 - num2;
-    return a->num1 - num1;
+    if (finLigne - ligne < 2 || !estBlanc(ligne[1]) || ligne[1] == '\r')
+        return 0;
+    if (ligne[0] == 'v' || ligne[0] == 'f')
+        return ligne[0];
+    return 0;
 }
 
 
 /**
- * @brief   Crée un nouveau nœud pour un arbre AVL.
- *
- * @param   num1    Premier sommet
- * @param   num2    Deuxième sommet
- * @param   faceA   Numéro de la face associée au nœud
- * @return  Nouveau nœud alloué dynamiquement
+ * @brief   Lit les coordonnées d'une ligne "v x y z" (0 pour celles qui manquent).
  */
-AreteAVL *createNode(int num1, int num2, int faceA)
+void lireSommet(const char *q, const char *finLigne, Vertex *s)
 {
-    AreteAVL *newNode = malloc(sizeof(AreteAVL));
-    newNode->num1 = num1;
-    newNode->num2 = num2;
-    newNode->left = newNode->right = NULL;
-    newNode->faceA = faceA;
-    newNode->hauteur = 0;
+    s->a = s->b = s->c = 0;
+    if (lireFloat(&q, finLigne, &s->a) && lireFloat(&q, finLigne, &s->b))
+        lireFloat(&q, finLigne, &s->c);
+}
 
-    return newNode;
+
+/**
+ * @brief   Lit les trois premiers indices d'une ligne "f ...".
+ * @param   numV    Nombre de sommets lus avant cette ligne (pour les indices négatifs)
+ * @return  1 si la face est valide, 0 sinon
+ */
+int lireFace(const char *q, const char *finLigne, int numV, Face *nf)
+{
+    return lireIndice(&q, finLigne, numV, &nf->v1) && lireIndice(&q, finLigne, numV, &nf->v2) &&
+           lireIndice(&q, finLigne, numV, &nf->v3);
 }
 
 
 /**
- * @brief   Insère un nouveau nœud dans un arbre AVL et détecte les arêtes équivalentes.
- *
- * @param   a       Racine de l'arbre AVL
- * @param   num1    Premier sommet du nouveau nœud
- * @param   num2    Deuxième sommet du nouveau nœud
- * @param   faceA   Numéro de la face associée au nouveau nœud
- * @return  Arêtes équivalentes(dual) détectées pendant l'insertion
+ * @brief   Vérifie que les faces ne désignent que des sommets du fichier : un indice positif
+ *          peut viser un sommet défini plus loin, il n'est contrôlé qu'une fois tout lu.
+ * @return  1 si tous les indices sont au plus numV, 0 sinon (la première face fautive est affichée)
  */
-AreteD *treeInsert(AreteAVL **a, int num1, int num2, int faceA)
+int verifierIndices(const Face *f, int numF, int numV)
 {
-    AreteAVL *treeRoot = *a;  //Récupère la racine de l'arbre AVL
-    if (treeRoot == NULL)
+    for (int i = 0; i < numF; i++)
     {
-        *a = createNode(num1, num2, faceA);   //Si l'arbre est vide, crée un nouveau nœud à la racine
-        return NULL;
+        int m = max(max(f[i].v1, f[i].v2), f[i].v3);
+        if (m > numV)
+        {
+            printf("Face %d : indice de sommet %d au-delà des %d sommets\n", i + 1, m, numV);
+            return 0;
+        }
     }
-    else if (sontEquivalentesA(treeRoot, num1, num2))   // Si le nouveau nœud est équivalent à la racine, détecte les arêtes équivalentes
+    return 1;
+}
+
+
+/**
+ * @brief   Lecture séquentielle du texte projeté dans des tableaux existants, agrandis au
+ *          besoin (capacité 0 : tableaux à créer). Permet de garder les tableaux d'un fichier
+ *          à l'autre (mode --lot).
+ * @param   capV    Capacité de *vertex, mise à jour
+ * @param   capF    Capacité de *face, mise à jour
+ * @return  NULL si la lecture est valide, sinon la cause de l'échec
+ */
+const char *lireObjDans(const char *data, size_t taille, Vertex **vertex, int *capV, Face **face, int *capF, int *numV,
+                 int *numF)
+{
+    int vCount = 0, fCount = 0;
+    if (*capV == 0)
     {
-        AreteD *newAreteD = malloc(sizeof(AreteD));
-        newAreteD->f1 = treeRoot->faceA;
-        newAreteD->f2 = faceA;
-        newAreteD->next = NULL;
-        return newAreteD;
+        *capV = 1024;
+        *vertex = allouer(sizeof(Vertex) * *capV);
     }
-    else   //Si le nouveau nœud n'est pas équivalent à la racine, effectue l'insertion récursive
+    if (*capF == 0)
     {
-        AreteD *equivalentEdgesList = NULL;
+        *capF = 1024;
+        *face = allouer(sizeof(Face) * *capF);
+    }
+    Vertex *v = *vertex;
+    Face *f = *face;
 
-        if (estSuperieureAVL(treeRoot, num1, num2) < 0)   //Si nouveau nœud plus grande que racine
+    const char *p = data;
+    const char *fin = data + taille;
+    while (p < fin)
+    {
+        const char *ligne = p;
+        const char *finLigne = memchr(p, '\n', fin - p);
+        if (finLigne == NULL)
+            finLigne = fin;
+        p = finLigne + 1;
+
+        char type = typeLigne(ligne, finLigne);
+        if (type == 'v')
         {
-            equivalentEdgesList = treeInsert(&(treeRoot->right), num1, num2, faceA);   //Insert à droite
-            treeRoot->right = treeRebalance(treeRoot->right);
+            if (vCount == *capV)
+            {
+                *capV *= 2;
+                v = reallouer(v, sizeof(Vertex) * (*capV / 2), sizeof(Vertex) * *capV);
+            }
+            lireSommet(ligne + 1, finLigne, &v[vCount++]);
         }
-        else       //Si nouveau nœud plus petite que racine
+        else if (type == 'f')
         {
-            equivalentEdgesList = treeInsert(&(treeRoot->left), num1, num2, faceA);    //Insert à gauche
-            treeRoot->left = treeRebalance(treeRoot->left);
+            Face nf;
+            if (lireFace(ligne + 1, finLigne, vCount, &nf))
+            {
+                if (fCount == *capF)
+                {
+                    *capF *= 2;
+                    f = reallouer(f, sizeof(Face) * (*capF / 2), sizeof(Face) * *capF);
+                }
+                f[fCount++] = nf;
+            }
         }
-
-        treeRoot = treeRebalance(treeRoot);
-        *a = treeRoot;
-        return equivalentEdgesList;    //Retourne la liste des arêtes équivalentes détectées pendant l'insertion
     }
+
+    *vertex = v;
+    *face = f;
+    *numV = vCount;
+    *numF = fCount;
+    return verifierIndices(f, fCount, vCount) ? NULL : "indice de sommet invalide";
 }
 
 
 /**
- * @brief   Trie les arêtes par AVL
- * @param   a        Tableau des arêtes
- * @param   n        Nombre d'arêtes
- * @return  Liste des arêtes équivalentes
+ * @brief   Lecture séquentielle du texte projeté dans des tableaux agrandis au besoin.
+ * @return  1 si la lecture est valide, 0 sinon
  */
-AreteD *triAVL(Arete *a, int n)
+int lireObjSequentiel(const char *data, size_t taille, Vertex **vertex, int *numV, Face **face, int *numF)
 {
-    AreteAVL *newTree = NULL;    //Initialise l'arbre AVL à NULL
-    AreteD *equivalentEdgesList = NULL;    
+    int capV = 0, capF = 0;
+    return lireObjDans(data, taille, vertex, &capV, face, &capF, numV, numF) == NULL;
+}
 
-    for (int i = 0; i < n; i++)
-    {
-        AreteD *x = treeInsert(&newTree, a[i].num1, a[i].num2, a[i].faceA);    //Insère le nœud correspondant à l'arête
-        if (x != NULL)    //Si des arêtes équivalentes sont détectées, les ajoute à la liste
-        {
-            AreteD *newAreteD = x;
-            newAreteD->next = equivalentEdgesList;
-            equivalentEdgesList = newAreteD;
-        }
-    }
 
-    return equivalentEdgesList;
-}
+typedef struct contexteLecture
+{
+    const char *data;
+    int nbT;
+    size_t *bornes;     //Début de chaque tranche (toujours en début de ligne), nbT + 1 cases
+    int *nbV, *nbF;     //Nombre de lignes v et f de chaque tranche, puis leur préfixe
+    int *invalides;     //Faces invalides de chaque tranche
+    Vertex *v;
+    Face *f;
+    pthread_barrier_t barriere;
+} ContexteLecture;
+
+typedef struct threadLecture
+{
+    ContexteLecture *ctx;
+    int id;
+} ThreadLecture;
 
 
-// coloration bfs
 /**
- * @brief   Crée un tableau de centroïdes couleur
- * @param   aretes          Liste des arêtes dual
- * @param   numVertices     Nombre de sommets
- * @param   selectedPoint   Point sélectionné
- * @param   maxDistancePtr  Pointeur vers la distance maximale
- * @return  Tableau de centroïdes couleur
+ * @brief   Travail d'un thread de lecture : compte les lignes v et f de sa tranche, attend
+ *          que le thread 0 ait calculé les préfixes et alloué les tableaux, puis écrit
+ *          directement ses sommets et ses faces à leur place définitive.
  */
-CentoideC *createCentoideArray(AreteD *aretes, int numVertices, int selectedPoint, int *maxDistancePtr)
+void *travailLecture(void *arg)
 {
-    CentoideC *centoideArray = (CentoideC *)malloc(numVertices * sizeof(CentoideC));
+    ThreadLecture *th = arg;
+    ContexteLecture *ctx = th->ctx;
+    const char *p = ctx->data + ctx->bornes[th->id];
+    const char *fin = ctx->data + ctx->bornes[th->id + 1];
 
-    for (int i = 0; i < numVertices; i++)  //Initialise les distances à -1 pour tous les sommets
+    int vCount = 0, fCount = 0;
+    for (const char *q = p; q < fin;)
     {
-        centoideArray[i].distance = -1;
+        const char *finLigne = memchr(q, '\n', fin - q);
+        if (finLigne == NULL)
+            finLigne = fin;
+        char type = typeLigne(q, finLigne);
+        vCount += (type == 'v');
+        fCount += (type == 'f');
+        q = finLigne + 1;
     }
+    ctx->nbV[th->id] = vCount;
+    ctx->nbF[th->id] = fCount;
 
-    centoideArray[selectedPoint - 1].distance = 0;  //Initialise la distance du sommet sélectionné à 0
-    *maxDistancePtr = 0;    
-
-    int distance = 1;
+    pthread_barrier_wait(&ctx->barriere);
+    if (th->id == 0)
+    {
+        int sommeV = 0, sommeF = 0;
+        for (int t = 0; t < ctx->nbT; t++)    //Préfixe : premier sommet et première face de chaque tranche
+        {
+            int nv = ctx->nbV[t], nf = ctx->nbF[t];
+            ctx->nbV[t] = sommeV;
+            ctx->nbF[t] = sommeF;
+            sommeV += nv;
+            sommeF += nf;
+        }
+        ctx->nbV[ctx->nbT] = sommeV;
+        ctx->nbF[ctx->nbT] = sommeF;
+        ctx->v = allouer(sizeof(Vertex) * max(sommeV, 1));
+        ctx->f = allouer(sizeof(Face) * max(sommeF, 1));
+    }
+    pthread_barrier_wait(&ctx->barriere);
 
-    while (distance < numVertices)
+    Vertex *v = ctx->v + ctx->nbV[th->id];
+    Face *f = ctx->f + ctx->nbF[th->id];
+    int vIndice = ctx->nbV[th->id];   //Sommets lus avant la ligne courante, pour les indices négatifs
+    int invalides = 0;
+    while (p < fin)
     {
-        for (int i = 0; i < numVertices; i++)
+        const char *ligne = p;
+        const char *finLigne = memchr(p, '\n', fin - p);
+        if (finLigne == NULL)
+            finLigne = fin;
+        p = finLigne + 1;
+
+        char type = typeLigne(ligne, finLigne);
+        if (type == 'v')
+        {
+            lireSommet(ligne + 1, finLigne, v++);
+            vIndice++;
+        }
+        else if (type == 'f')
         {
-            if (centoideArray[i].distance == distance - 1)  //Si le sommet a une distance égale à distance - 1
+            if (!lireFace(ligne + 1, finLigne, vIndice, f))
             {
-                AreteD *tmp = aretes;
-                while (tmp != NULL)
-                {
-                    if (tmp->f1 == i && centoideArray[tmp->f2].distance == -1)  //Met à jour la distance du sommet voisin non visité
-                    {
-                        centoideArray[tmp->f2].distance = distance;
-
-                        if (distance > *maxDistancePtr)
-                        {
-                            *maxDistancePtr = distance;
-                        }
-                    }
-                    else if (tmp->f2 == i && centoideArray[tmp->f1].distance == -1)
-                    {
-                        centoideArray[tmp->f1].distance = distance;
-
-                        if (distance > *maxDistancePtr)
-                        {
-                            *maxDistancePtr = distance;
-                        }
-                    }
-                    tmp = tmp->next;
-                }
+                f->v1 = 0;    //Marquée invalide, retirée ensuite
+                invalides++;
             }
+            f++;
         }
-        distance++;
     }
-
-    return centoideArray;   // Retourne le tableau de structures CentoideC
+    ctx->invalides[th->id] = invalides;
+    return NULL;
 }
 
 
 /**
- * @brief   Écrit un fichier .obj avec des couleurs basées sur la distance
- * @param   centoides       Tableau des centroïdes
- * @param   numface         Nombre de faces
- * @param   filename        Nom du fichier de sortie (par exemple bunny_colored.obj)
- * @param   equivalentAretes Liste des arêtes équivalentes
+ * @brief   Lecture parallèle : le texte est coupé en tranches aux fins de ligne, une par thread.
  */
-void writeObjFile(Centoide *centoides, int numface, const char *filename, AreteD *equivalentAretes)
+void lireObjParallele(const char *data, size_t taille, int nbT, Vertex **vertex, int *numV, Face **face, int *numF)
 {
-    FILE *file = fopen(filename, "w");
-    if (file == NULL)
+    ContexteLecture ctx;
+    ctx.data = data;
+    ctx.nbT = nbT;
+    ctx.bornes = malloc(sizeof(size_t) * (nbT + 1));
+    ctx.nbV = malloc(sizeof(int) * (nbT + 1));
+    ctx.nbF = malloc(sizeof(int) * (nbT + 1));
+    ctx.invalides = malloc(sizeof(int) * nbT);
+
+    ctx.bornes[0] = 0;
+    for (int t = 1; t < nbT; t++)
     {
-        fprintf(stderr, "write\n");
-        return;
+        size_t b = max(taille / nbT * t, ctx.bornes[t - 1]);
+        while (b > 0 && b < taille && data[b - 1] != '\n')   //Avance jusqu'au début de la ligne suivante
+            b++;
+        ctx.bornes[t] = b;
     }
+    ctx.bornes[nbT] = taille;
 
-    int numCentoides = numface;
-    int maxDistance;
-    CentoideC *cc = createCentoideArray(equivalentAretes, numface, equivalentAretes->f1, &maxDistance);     // crée centoide couleur
-    printf("%d\n", maxDistance);
-    float parametre = 1.0 / maxDistance;    //Calculer l'unité
-    printf("%f\n", parametre);
+    pthread_barrier_init(&ctx.barriere, NULL, nbT);
+    pthread_t *threads = malloc(nbT * sizeof(pthread_t));
+    ThreadLecture *args = malloc(nbT * sizeof(ThreadLecture));
+    for (int t = 0; t < nbT; t++)
+    {
+        args[t].ctx = &ctx;
+        args[t].id = t;
+        pthread_create(&threads[t], NULL, travailLecture, &args[t]);
+    }
+    for (int t = 0; t < nbT; t++)
+        pthread_join(threads[t], NULL);
+    pthread_barrier_destroy(&ctx.barriere);
+
+    int fCount = ctx.nbF[nbT];
+    int invalides = 0;
+    for (int t = 0; t < nbT; t++)
+        invalides += ctx.invalides[t];
+    if (invalides > 0)    //Rare : on tasse les faces valides
+    {
+        int k = 0;
+        for (int i = 0; i < fCount; i++)
+        {
+            if (ctx.f[i].v1 != 0)
+                ctx.f[k++] = ctx.f[i];
+        }
+        fCount = k;
+    }
 
-    for (int i = 0; i < numCentoides; i++)   //Rouge 1 0 0  vert 0 1 0
+    *vertex = ctx.v;
+    *face = ctx.f;
+    *numV = ctx.nbV[nbT];
+    *numF = fCount;
+
+    free(threads);
+    free(args);
+    free(ctx.bornes);
+    free(ctx.nbV);
+    free(ctx.nbF);
+    free(ctx.invalides);
+}
+
+
+/**
+ * @brief   Lit le fichier .obj en une seule passe sur le fichier projeté en mémoire
+ *
+ * Les faces acceptent les syntaxes a/b/c et les indices négatifs ; seules les trois premières
+ * sont gardées pour un polygone, comme dans readObj. Avec plusieurs threads (option -j) et un
+ * fichier assez gros, la lecture se fait en parallèle (lireObjParallele).
+ *
+ * @param   filename Nom du fichier (par exemple bunny.obj)
+ * @param   vertex   Tableau des sommets
+ * @param   numV     Nombre de sommets
+ * @param   face     Tableau des faces
+ * @param   numF     Nombre de faces
+ * @return  1 en cas de succès, 0 en cas d'échec
+ */
+int readObjMmap(const char *filename, Vertex **vertex, int *numV, Face **face, int *numF)
+{
+    double debut = tempsMur();
+    size_t taille;
+    const char *data = projeterFichier(filename, &taille);
+    if (data == NULL)
     {
-        fprintf(file, "v %f %f %f %f %f %f\n", centoides[i].centre.a, centoides[i].centre.b, centoides[i].centre.c, (1.0 - cc[i].distance) * parametre, cc[i].distance * parametre, 0.0);
+        printf("Impossible d'ouvrir le fichier .obj\n");
+        return 0;
     }
 
-    AreteD *current = equivalentAretes;
-    while (current != NULL)
+    int nbT = (int)min((size_t)max(nbThreads, 1), taille / (1 << 20) + 1);   //Au moins 1 Mo par thread
+    int ok;
+    if (nbT > 1)
     {
-        fprintf(file, "l %d %d\n", current->f1 + 1, current->f2 + 1);
-        current = current->next;
+        lireObjParallele(data, taille, nbT, vertex, numV, face, numF);
+        ok = verifierIndices(*face, *numF, *numV);
     }
+    else
+        ok = lireObjSequentiel(data, taille, vertex, numV, face, numF);
 
-    while (equivalentAretes != NULL)    //Free arête dual
+    munmap((void *)data, taille);
+    if (!ok)
     {
-        AreteD *temp = equivalentAretes;
-        equivalentAretes = equivalentAretes->next;
-        free(temp);
+        free(*vertex);
+        free(*face);
+        return 0;
     }
 
-    free(cc);
-    fclose(file);
+    double temps = tempsMur() - debut;
+    double mo = taille / (1024.0 * 1024.0);
+    printf("Lecture : %.2f Mo en %f s (%.1f Mo/s, %d thread%s)\n", mo, temps, temps > 0 ? mo / temps : 0.0,
+           nbT, nbT > 1 ? "s" : "");
+    return 1;
 }
 
-/*
-int facevoisin(Centoide c1, Centoide c2, Face *face)
-{
-    int tmp = 0;
 
-    Face f1 = face[c1.faceAssocie];
-    Face f2 = face[c2.faceAssocie];
+// écriture tamponnée
 
-    if (f1.v1 == f2.v1 || f1.v1 == f2.v2 || f1.v1 == f2.v3)
-        tmp++;
-    if (f1.v2 == f2.v1 || f1.v2 == f2.v2 || f1.v2 == f2.v3)
-        tmp++;
-    if (f1.v3 == f2.v1 || f1.v3 == f2.v2 || f1.v3 == f2.v3)
-        tmp++;
+#define TAMPON_TAILLE (1 << 20)
 
-    return (tmp == 2) ? 1 : 0;
-}
+int ecritureAsynchrone = 0;    //Option --ecriture-async : un thread d'E/S écrit pendant le formatage
 
-Arete *selectSort(Centoide *c, Face *face, int numf, int numv, int *numA)
+typedef struct tampon
 {
-    int nbDeAreM = numf + numv;
-    Arete *a = malloc(sizeof(Arete) * nbDeAreM);
-    int tmp = 0;
-    int i, j;
+    int fd;
+    char *buf;              //Tampon en cours de remplissage
+    size_t pos;
+    size_t taille;          //Taille de buf (et de autre)
+    int erreur;
+    //Double tampon : le thread d'E/S écrit "autre" pendant que l'on remplit "buf"
+    int asynchrone;
+    char *autre;
+    size_t aEcrire;         //Octets de "autre" à écrire, 0 si le thread est libre
+    int arret;
+    pthread_t thread;
+    pthread_mutex_t verrou;
+    pthread_cond_t cond;
+} Tampon;
+
+
+/**
+ * @brief   Écrit tout un bloc, en reprenant après les écritures partielles.
+ * @return  1 en cas de succès, 0 en cas d'échec
+ */
+static int ecrireTout(int fd, const char *data, size_t taille)
+{
+    while (taille > 0)
+    {
+        ssize_t n = write(fd, data, taille);
+        if (n <= 0)
+            return 0;
+        data += n;
+        taille -= n;
+    }
+    return 1;
+}
+
+
+void *travailEcriture(void *arg)
+{
+    Tampon *t = arg;
+    pthread_mutex_lock(&t->verrou);
+    while (1)
+    {
+        while (t->aEcrire == 0 && !t->arret)
+            pthread_cond_wait(&t->cond, &t->verrou);
+        if (t->aEcrire == 0 && t->arret)
+            break;
+
+        size_t taille = t->aEcrire;
+        pthread_mutex_unlock(&t->verrou);
+        int ok = ecrireTout(t->fd, t->autre, taille);
+        pthread_mutex_lock(&t->verrou);
+        if (!ok)
+            t->erreur = 1;
+        t->aEcrire = 0;
+        pthread_cond_broadcast(&t->cond);
+    }
+    pthread_mutex_unlock(&t->verrou);
+    return NULL;
+}
+
+
+/**
+ * @brief   Ouvre un fichier en écriture avec un tampon de taille donnée en espace utilisateur.
+ * @param   filename    Nom du fichier
+ * @param   asynchrone  1 pour écrire depuis un thread d'E/S (double tampon)
+ * @param   taille      Taille du tampon (au moins quelques Ko : une ligne doit y tenir)
+ * @return  Le tampon, NULL en cas d'échec
+ */
+Tampon *ouvrirTamponTaille(const char *filename, int asynchrone, size_t taille)
+{
+    int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return NULL;
+
+    Tampon *t = calloc(1, sizeof(Tampon));
+    t->fd = fd;
+    t->taille = taille;
+    t->buf = allouer(taille);
+    t->asynchrone = asynchrone;
+    if (asynchrone)
+    {
+        t->autre = allouer(taille);
+        pthread_mutex_init(&t->verrou, NULL);
+        pthread_cond_init(&t->cond, NULL);
+        pthread_create(&t->thread, NULL, travailEcriture, t);
+    }
+    return t;
+}
+
+
+/**
+ * @brief   Ouvre un fichier en écriture avec un grand tampon (TAMPON_TAILLE).
+ */
+Tampon *ouvrirTampon(const char *filename, int asynchrone)
+{
+    return ouvrirTamponTaille(filename, asynchrone, TAMPON_TAILLE);
+}
+
+
+/**
+ * @brief   Vide le tampon : écriture directe, ou passage au thread d'E/S.
+ */
+static void viderTampon(Tampon *t)
+{
+    if (t->pos == 0)
+        return;
+    if (!t->asynchrone)
+    {
+        if (!ecrireTout(t->fd, t->buf, t->pos))
+            t->erreur = 1;
+        t->pos = 0;
+        return;
+    }
+
+    pthread_mutex_lock(&t->verrou);
+    while (t->aEcrire != 0)    //Attend que l'autre tampon soit écrit
+        pthread_cond_wait(&t->cond, &t->verrou);
+    char *x = t->autre;
+    t->autre = t->buf;
+    t->buf = x;
+    t->aEcrire = t->pos;
+    pthread_cond_broadcast(&t->cond);
+    pthread_mutex_unlock(&t->verrou);
+    t->pos = 0;
+}
+
+
+/**
+ * @brief   Garantit au moins n octets libres dans le tampon.
+ */
+static inline char *reserverTampon(Tampon *t, size_t n)
+{
+    if (t->pos + n > t->taille)
+        viderTampon(t);
+    return t->buf + t->pos;
+}
+
+
+/**
+ * @brief   Ajoute un texte au tampon.
+ */
+void tamponTexte(Tampon *t, const char *texte)
+{
+    size_t n = strlen(texte);
+    char *p = reserverTampon(t, n);
+    memcpy(p, texte, n);
+    t->pos += n;
+}
+
+
+/**
+ * @brief   Ajoute un entier en décimal (comme %d).
+ */
+void tamponInt(Tampon *t, int x)
+{
+    char chiffres[12];
+    char *p = reserverTampon(t, 12);
+    unsigned int u = (x < 0) ? 0u - (unsigned int)x : (unsigned int)x;
+    int n = 0;
+    do
+    {
+        chiffres[n++] = '0' + u % 10;
+        u /= 10;
+    } while (u != 0);
+    if (x < 0)
+        *p++ = '-';
+    while (n > 0)
+        *p++ = chiffres[--n];
+    t->pos = p - t->buf;
+}
+
+
+/**
+ * @brief   Ajoute des octets bruts (formats binaires).
+ */
+void tamponOctets(Tampon *t, const void *data, size_t n)
+{
+    const char *x = data;
+    while (n > 0)
+    {
+        size_t k = min(n, t->taille);
+        memcpy(reserverTampon(t, k), x, k);
+        t->pos += k;
+        x += k;
+        n -= k;
+    }
+}
+
+
+/**
+ * @brief   Ajoute un entier non signé en varint : 7 bits par octet, poids faibles d'abord,
+ *          bit de poids fort à 1 tant qu'il reste des octets.
+ */
+void tamponVarint(Tampon *t, uint32_t x)
+{
+    char *p = reserverTampon(t, 5);
+    while (x >= 0x80)
+    {
+        *p++ = (char)(x | 0x80);
+        x >>= 7;
+    }
+    *p++ = (char)x;
+    t->pos = p - t->buf;
+}
+
+
+/**
+ * @brief   Formate un double comme printf("%f") : six décimales, même arrondi, même texte.
+ *
+ * La valeur exacte m·2^e est multipliée par 10^6 en entier 128 bits, puis arrondie au plus
+ * proche (à égalité, vers le pair, comme la glibc). Les cas hors de portée (très grandes
+ * valeurs, inf, nan) passent par snprintf.
+ *
+ * @param   out     Au moins 32 octets
+ * @param   x       Valeur
+ * @return  Nombre de caractères écrits
+ */
+int formaterF(char *out, double x)
+{
+    uint64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    int neg = (int)(bits >> 63);
+    int expo = (int)((bits >> 52) & 0x7FF);
+    uint64_t m = bits & ((1ULL << 52) - 1);
+
+    if (expo == 0x7FF || (x > 0 ? x : -x) >= 9.0e12)
+        return snprintf(out, 32, "%f", x);
+
+    int e;
+    if (expo == 0)
+        e = -1074;    //Dénormalisé
+    else
+    {
+        m |= 1ULL << 52;
+        e = expo - 1075;
+    }
+
+    unsigned __int128 p = (unsigned __int128)m * 1000000u;
+    uint64_t n;
+    if (e >= 0)
+        n = (uint64_t)(p << e);
+    else if (-e > 100)
+        n = 0;    //Moins d'un demi-millionième
+    else
+    {
+        int s = -e;
+        unsigned __int128 q = p >> s;
+        unsigned __int128 r = p - (q << s);
+        unsigned __int128 moitie = (unsigned __int128)1 << (s - 1);
+        if (r > moitie || (r == moitie && (q & 1)))
+            q++;
+        n = (uint64_t)q;
+    }
+
+    char *o = out;
+    if (neg)
+        *o++ = '-';
+    uint64_t entier = n / 1000000;
+    int frac = (int)(n % 1000000);
+    char chiffres[20];
+    int k = 0;
+    do
+    {
+        chiffres[k++] = '0' + entier % 10;
+        entier /= 10;
+    } while (entier != 0);
+    while (k > 0)
+        *o++ = chiffres[--k];
+    *o++ = '.';
+    for (int i = 5; i >= 0; i--)
+    {
+        o[i] = '0' + frac % 10;
+        frac /= 10;
+    }
+    o += 6;
+    return o - out;
+}
+
+
+/**
+ * @brief   Ajoute un flottant au format %f.
+ */
+void tamponFloat(Tampon *t, double x)
+{
+    char *p = reserverTampon(t, 32);
+    t->pos += formaterF(p, x);
+}
+
+
+/**
+ * @brief   Vide le tampon, arrête le thread d'E/S et ferme le fichier.
+ * @return  1 si tout a été écrit, 0 en cas d'erreur
+ */
+int fermerTampon(Tampon *t)
+{
+    viderTampon(t);
+    if (t->asynchrone)
+    {
+        pthread_mutex_lock(&t->verrou);
+        t->arret = 1;
+        pthread_cond_broadcast(&t->cond);
+        pthread_mutex_unlock(&t->verrou);
+        pthread_join(t->thread, NULL);
+        pthread_mutex_destroy(&t->verrou);
+        pthread_cond_destroy(&t->cond);
+        free(t->autre);
+    }
+    int ok = !t->erreur;
+    if (close(t->fd) != 0)
+        ok = 0;
+    free(t->buf);
+    free(t);
+    return ok;
+}
+
+
+/**
+ * @brief   Écrit une chaîne JSON entre guillemets (guillemets, barres obliques inverses et
+ *          caractères de contrôle échappés).
+ */
+void ecrireChaineJSON(FILE *out, const char *texte)
+{
+    fputc('"', out);
+    for (const unsigned char *c = (const unsigned char *)texte; *c; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            fprintf(out, "\\%c", *c);
+        else if (*c < 0x20)
+            fprintf(out, "\\u%04x", *c);
+        else
+            fputc(*c, out);
+    }
+    fputc('"', out);
+}
+
+
+/**
+ * @brief   Écrit un champ CSV, entre guillemets (doublés à l'intérieur) s'il contient une
+ *          virgule, un guillemet ou un saut de ligne.
+ */
+void ecrireChampCSV(FILE *out, const char *texte)
+{
+    if (strpbrk(texte, ",\"\r\n") == NULL)
+    {
+        fputs(texte, out);
+        return;
+    }
+    fputc('"', out);
+    for (const char *c = texte; *c; c++)
+    {
+        if (*c == '"')
+            fputc('"', out);
+        fputc(*c, out);
+    }
+    fputc('"', out);
+}
+
+
+/**
+ * @brief   Écrit le fichier .obj
+ * @param   filename Nom du fichier (par exemple test.obj)
+ * @param   vertex   Tableau des sommets
+ * @param   numV     Nombre de sommets
+ * @param   face     Tableau des faces
+ * @param   numF     Nombre de faces
+ * @return  1 en cas de succès, 0 en cas d'échec
+ */
+int writeOBJ(const char *filename, Vertex *vertex, int numV, Face *face, int numF)
+{
+    Tampon *file = ouvrirTampon(filename, ecritureAsynchrone);
+    if (!file)
+    {
+        printf("Impossible d'ouvrir le fichier .obj\n");
+        return 0;
+    }
+
+    for (int i = 0; i < numV; i++)    //"v %f %f %f\n"
+    {
+        tamponTexte(file, "v ");
+        tamponFloat(file, vertex[i].a);
+        tamponTexte(file, " ");
+        tamponFloat(file, vertex[i].b);
+        tamponTexte(file, " ");
+        tamponFloat(file, vertex[i].c);
+        tamponTexte(file, "\n");
+    }
+    for (int a = 0; a < numF; a++)    //"f %d %d %d\n"
+    {
+        tamponTexte(file, "f ");
+        tamponInt(file, face[a].v1);
+        tamponTexte(file, " ");
+        tamponInt(file, face[a].v2);
+        tamponTexte(file, " ");
+        tamponInt(file, face[a].v3);
+        tamponTexte(file, "\n");
+    }
+
+    return fermerTampon(file);
+}
+
+
+/**
+ * @brief   Calcule les centroïdes des faces
+ * @param   vertex   Tableau des sommets
+ * @param   numV     Nombre de sommets
+ * @param   face     Tableau des faces
+ * @param   numF     Nombre de faces
+ * @return  Tableau des centroïdes
+ */
+Centoide *calculateCentroids(Vertex *vertex, int numV, Face *face, int numF)
+{
+    Centoide *centroids = allouer(sizeof(Centoide) * numF);
+    for (int i = 0; i < numF; i++)
+    {
+        centroids[i].centre.a = (vertex[face[i].v1 - 1].a + vertex[face[i].v2 - 1].a + vertex[face[i].v3 - 1].a) / 3.0;
+        centroids[i].centre.b = (vertex[face[i].v1 - 1].b + vertex[face[i].v2 - 1].b + vertex[face[i].v3 - 1].b) / 3.0;
+        centroids[i].centre.c = (vertex[face[i].v1 - 1].c + vertex[face[i].v2 - 1].c + vertex[face[i].v3 - 1].c) / 3.0;
+    }
+    return centroids;
+}
+
+
+/**
+ * @brief   Généralise les arêtes à partir des faces
+ * @param   f        Tableau des faces
+ * @param   numF     Nombre de faces
+ * @param   v        Tableau des sommets
+ * @return  Tableau des arêtes généralisées
+ */
+Arete *generalise(Face *f, int numF, Vertex *v)
+{
+    int numEdges = numF * 3;    //Un face a 3 arêtes 
+    Arete *aretes = (Arete *)allouer(numEdges * sizeof(Arete));
+
+    for (int i = 0; i < numF; i++)
+    {
+        int v1Index = f[i].v1;    //index de sommets
+        int v2Index = f[i].v2;
+        int v3Index = f[i].v3;
+
+        // Vertex v1 = v[v1Index];      L'idée initiale
+        // Vertex v2 = v[v2Index];
+        // Vertex v3 = v[v3Index];
+
+        // aretes[i * 3].sommet1 = v1;
+        // aretes[i * 3].sommet2 = v2;
+        if (v1Index < v2Index)     //Toujours placer les plus petits en premier pour faciliter la comparaison et le tri.
+        {
+            aretes[i * 3].num1 = v1Index;   //En utilisant les positions des trois sommets dans le tableau de sommets à l'intérieur de la face, 
+            aretes[i * 3].num2 = v2Index;   //attribuez des numéros aux deux sommets de l'arête.
+        }
+        else
+        {
+            aretes[i * 3].num1 = v2Index;
+            aretes[i * 3].num2 = v1Index;
+        }
+        aretes[i * 3].faceA = i;    //Face associe
+
+        // aretes[i * 3 + 1].sommet1 = v2;
+        // aretes[i * 3 + 1].sommet2 = v3;
+        if (v2Index < v3Index)
+        {
+            aretes[i * 3 + 1].num1 = v2Index;
+            aretes[i * 3 + 1].num2 = v3Index;
+        }
+        else
+        {
+            aretes[i * 3 + 1].num1 = v3Index;
+            aretes[i * 3 + 1].num2 = v2Index;
+        }
+        aretes[i * 3 + 1].faceA = i;
+
+        // aretes[i * 3 + 2].sommet1 = v3;
+        // aretes[i * 3 + 2].sommet2 = v1;
+        if (v1Index < v3Index)
+        {
+            aretes[i * 3 + 2].num1 = v1Index;
+            aretes[i * 3 + 2].num2 = v3Index;
+        }
+        else
+        {
+            aretes[i * 3 + 2].num1 = v3Index;
+            aretes[i * 3 + 2].num2 = v1Index;
+        }
+        aretes[i * 3 + 2].faceA = i;    
+    }
+
+    return aretes;
+}
+
+
+// passe fusionnée sur les faces (SoA, SIMD)
+
+#define UN_TIERS (1.0 / 3.0)
+
+/**
+ * @brief   Sommets rangés en structure de tableaux : une face lit ses trois sommets par
+ *          rassemblement (gather) dans x, y et z. L'indice 0 est un sommet factice pour
+ *          adresser directement avec les indices du .obj, qui commencent à 1.
+ */
+typedef struct sommetsSoA
+{
+    float *x, *y, *z;
+    int numV;
+} SommetsSoA;
+
+
+/**
+ * @brief   Remplit une structure de tableaux existante, agrandie au besoin
+ * @param   s       Sommets SoA
+ * @param   cap     Capacité des tableaux de s (0 : à créer), mise à jour
+ * @param   v       Tableau des sommets
+ * @param   numV    Nombre de sommets
+ */
+void remplirSoA(SommetsSoA *s, int *cap, Vertex *v, int numV)
+{
+    if (numV + 1 > *cap)
+    {
+        size_t avant = sizeof(float) * *cap;
+        *cap = numV + 1;
+        s->x = reallouer(s->x, avant, sizeof(float) * *cap);
+        s->y = reallouer(s->y, avant, sizeof(float) * *cap);
+        s->z = reallouer(s->z, avant, sizeof(float) * *cap);
+    }
+    s->numV = numV;
+    s->x[0] = s->y[0] = s->z[0] = 0;
+    for (int i = 0; i < numV; i++)
+    {
+        s->x[i + 1] = v[i].a;
+        s->y[i + 1] = v[i].b;
+        s->z[i + 1] = v[i].c;
+    }
+}
+
+/**
+ * @brief   Convertit le tableau de sommets en structure de tableaux
+ * @param   v       Tableau des sommets
+ * @param   numV    Nombre de sommets
+ * @return  Sommets SoA (à libérer avec libererSoA)
+ */
+SommetsSoA sommetsSoA(Vertex *v, int numV)
+{
+    SommetsSoA s = {NULL, NULL, NULL, 0};
+    int cap = 0;
+    remplirSoA(&s, &cap, v, numV);
+    return s;
+}
+
+void libererSoA(SommetsSoA *s)
+{
+    free(s->x);
+    free(s->y);
+    free(s->z);
+}
+
+
+/**
+ * @brief   Noyau scalaire : centroïdes et arêtes ordonnées des faces [debut, fin[.
+ *
+ * La somme est faite en float puis multipliée par 1/3 en double : l'arrondi en float donne
+ * exactement le même résultat que la division par 3.0 de calculateCentroids (l'écart entre
+ * x * (1/3) et x / 3 en double est bien plus petit que la distance de x / 3 à un milieu
+ * entre deux floats). min/max remplacent les branches de generalise.
+ */
+static void noyauFacesScalaire(const SommetsSoA *s, const Face *f, int debut, int fin, Centoide *c, Arete *a)
+{
+    for (int i = debut; i < fin; i++)
+    {
+        int v1 = f[i].v1, v2 = f[i].v2, v3 = f[i].v3;
+        float sx = s->x[v1] + s->x[v2] + s->x[v3];
+        float sy = s->y[v1] + s->y[v2] + s->y[v3];
+        float sz = s->z[v1] + s->z[v2] + s->z[v3];
+        c[i].centre.a = sx * UN_TIERS;
+        c[i].centre.b = sy * UN_TIERS;
+        c[i].centre.c = sz * UN_TIERS;
+
+        a[i * 3] = (Arete){min(v1, v2), max(v1, v2), i};
+        a[i * 3 + 1] = (Arete){min(v2, v3), max(v2, v3), i};
+        a[i * 3 + 2] = (Arete){min(v1, v3), max(v1, v3), i};
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+static __attribute__((target("avx2"))) __m256 tiersAVX2(__m256 somme)
+{
+    __m256d bas = _mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(somme)), _mm256_set1_pd(UN_TIERS));
+    __m256d haut = _mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(somme, 1)), _mm256_set1_pd(UN_TIERS));
+    return _mm256_set_m128(_mm256_cvtpd_ps(haut), _mm256_cvtpd_ps(bas));
+}
+
+
+/**
+ * @brief   Noyau AVX2 : huit faces par itération. Les indices sont lus par gather (pas de 3
+ *          entiers), les coordonnées par gather dans le SoA, les sommes sont faites dans le
+ *          même ordre que le noyau scalaire et min/max sont des instructions vectorielles.
+ */
+static __attribute__((target("avx2"))) void noyauFacesAVX2(const SommetsSoA *s, const Face *f, int debut, int fin,
+                                                           Centoide *c, Arete *a)
+{
+    const __m256i pas = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+    int i = debut;
+    for (; i + 8 <= fin; i += 8)
+    {
+        const int *base = &f[i].v1;
+        __m256i v1 = _mm256_i32gather_epi32(base, pas, 4);
+        __m256i v2 = _mm256_i32gather_epi32(base + 1, pas, 4);
+        __m256i v3 = _mm256_i32gather_epi32(base + 2, pas, 4);
+
+        __m256 sx = _mm256_add_ps(_mm256_add_ps(_mm256_i32gather_ps(s->x, v1, 4), _mm256_i32gather_ps(s->x, v2, 4)),
+                                  _mm256_i32gather_ps(s->x, v3, 4));
+        __m256 sy = _mm256_add_ps(_mm256_add_ps(_mm256_i32gather_ps(s->y, v1, 4), _mm256_i32gather_ps(s->y, v2, 4)),
+                                  _mm256_i32gather_ps(s->y, v3, 4));
+        __m256 sz = _mm256_add_ps(_mm256_add_ps(_mm256_i32gather_ps(s->z, v1, 4), _mm256_i32gather_ps(s->z, v2, 4)),
+                                  _mm256_i32gather_ps(s->z, v3, 4));
+
+        float cx[8], cy[8], cz[8];
+        int n1[8], m1[8], n2[8], m2[8], n3[8], m3[8];
+        _mm256_storeu_ps(cx, tiersAVX2(sx));
+        _mm256_storeu_ps(cy, tiersAVX2(sy));
+        _mm256_storeu_ps(cz, tiersAVX2(sz));
+        _mm256_storeu_si256((__m256i *)n1, _mm256_min_epi32(v1, v2));
+        _mm256_storeu_si256((__m256i *)m1, _mm256_max_epi32(v1, v2));
+        _mm256_storeu_si256((__m256i *)n2, _mm256_min_epi32(v2, v3));
+        _mm256_storeu_si256((__m256i *)m2, _mm256_max_epi32(v2, v3));
+        _mm256_storeu_si256((__m256i *)n3, _mm256_min_epi32(v1, v3));
+        _mm256_storeu_si256((__m256i *)m3, _mm256_max_epi32(v1, v3));
+
+        for (int k = 0; k < 8; k++)    //Retour au format tableau de structures des appelants
+        {
+            c[i + k].centre = (Vertex){cx[k], cy[k], cz[k]};
+            a[(i + k) * 3] = (Arete){n1[k], m1[k], i + k};
+            a[(i + k) * 3 + 1] = (Arete){n2[k], m2[k], i + k};
+            a[(i + k) * 3 + 2] = (Arete){n3[k], m3[k], i + k};
+        }
+    }
+    noyauFacesScalaire(s, f, i, fin, c, a);
+}
+#endif
+
+typedef void (*NoyauFaces)(const SommetsSoA *, const Face *, int, int, Centoide *, Arete *);
+
+int forcerScalaire = 0;     //Option --scalaire : ignore les noyaux SIMD
+
+/**
+ * @brief   Choisit le noyau selon le processeur (à l'exécution)
+ * @param   nom     Reçoit le nom du noyau choisi, peut être NULL
+ */
+NoyauFaces choisirNoyauFaces(const char **nom)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    if (!forcerScalaire && __builtin_cpu_supports("avx2"))
+    {
+        if (nom != NULL)
+            *nom = "avx2";
+        return noyauFacesAVX2;
+    }
+#endif
+    if (nom != NULL)
+        *nom = "scalaire";
+    return noyauFacesScalaire;
+}
+
+
+/**
+ * @brief   Passe unique sur les faces : centroïdes et arêtes ordonnées ensemble, mêmes
+ *          résultats que calculateCentroids puis generalise.
+ * @param   s           Sommets SoA
+ * @param   f           Tableau des faces
+ * @param   numF        Nombre de faces
+ * @param   centroides  Reçoit le tableau des centroïdes
+ * @param   aretes      Reçoit le tableau des arêtes (3 par face)
+ */
+void passeFaces(const SommetsSoA *s, Face *f, int numF, Centoide **centroides, Arete **aretes)
+{
+    *centroides = allouer(sizeof(Centoide) * max(numF, 1));
+    *aretes = allouer(sizeof(Arete) * 3 * max(numF, 1));
+    NoyauFaces noyau = choisirNoyauFaces(NULL);
+    noyau(s, f, 0, numF, *centroides, *aretes);
+}
+
+
+/**
+ * @brief   Vérifie si deux arêtes sont équivalentes
+ * @param   a1       Première arête
+ * @param   a2       Deuxième arête
+ * @return  1 si équivalentes, 0 sinon
+ */
+int sontEquivalentes(Arete a1, Arete a2)
+{
+    // if ((a1.sommet1.a == a2.sommet1.a && a1.sommet1.b == a2.sommet1.b && a1.sommet1.c == a2.sommet1.c) &&
+    //     (a1.sommet2.a == a2.sommet2.a && a1.sommet2.b == a2.sommet2.b && a1.sommet2.c == a2.sommet2.c))
+    // {
+    //     return 1;
+    // }
+
+    // if ((a1.sommet1.a == a2.sommet2.a && a1.sommet1.b == a2.sommet2.b && a1.sommet1.c == a2.sommet2.c) &&
+    //     (a1.sommet2.a == a2.sommet1.a && a1.sommet2.b == a2.sommet1.b && a1.sommet2.c == a2.sommet1.c))
+    // {
+    //     return 1;
+    // }
+
+    if ((a1.num1 == a2.num1) && (a1.num2 == a2.num2))  //Si deux sommets de arête1 = arête2, deux arête sont equivalent
+        return 1;
+    return 0;
+}
+
+
+/**
+ * @brief   Compare deux arêtes pour déterminer si l'arête 1 est supérieure à l'arête 2.
+ *
+ * La comparaison est basée sur les indices des sommets de l'arête.
+ * Si les numéros des sommets sont égaux, la fonction compare les numéros des autres sommets.
+ *
+ * @param   arete1 Première arête
+ * @param   arete2 Deuxième arête
+ * @return  Un entier négatif si arete1 est inférieure à arete2,
+ *          un entier positif si arete1 est supérieure à arete2,
+ *          et zéro si les arêtes sont équivalentes.
+ */
+int estSuperieureA(Arete arete1, Arete arete2)
+{
+    compteurComparaisons++;
+    if (arete1.num1 == arete2.num1)
+        return arete1.num2 - arete2.num2;
+    return arete1.num1 - arete2.num1;
+}
+
+
+// arène
+
+#define ARENA_BLOC_MIN (64 * 1024)
+
+/**
+ * @brief   Garantit au moins taille octets libres d'un seul tenant dans l'arène, en ouvrant
+ *          un nouveau bloc si besoin. Permet de dimensionner l'arène d'avance.
+ * @param   ar      Arène
+ * @param   taille  Octets à réserver
+ */
+void arenaReserver(Arena *ar, size_t taille)
+{
+    if (ar->numBlocs > 0 && ar->tailles[ar->numBlocs - 1] - ar->pos >= taille)
+        return;
+
+    if (ar->numBlocs == ar->capBlocs)
+    {
+        ar->capBlocs = max(ar->capBlocs * 2, 8);
+        ar->blocs = realloc(ar->blocs, ar->capBlocs * sizeof(char *));
+        ar->tailles = realloc(ar->tailles, ar->capBlocs * sizeof(size_t));
+    }
+    taille = max(taille, (size_t)ARENA_BLOC_MIN);
+    ar->blocs[ar->numBlocs] = malloc(taille);
+    ar->tailles[ar->numBlocs] = taille;
+    ar->numBlocs++;
+    ar->pos = 0;
+    ar->reserve += taille;
+}
+
+
+/**
+ * @brief   Alloue taille octets (alignés sur 8) en avançant dans le bloc courant.
+ * @param   ar      Arène
+ * @param   taille  Octets demandés
+ * @return  La zone allouée, libérée seulement avec toute l'arène
+ */
+static inline void *arenaAlloc(Arena *ar, size_t taille)
+{
+    taille = (taille + 7) & ~(size_t)7;
+    if (ar->numBlocs == 0 || ar->tailles[ar->numBlocs - 1] - ar->pos < taille)
+        arenaReserver(ar, max(taille, ar->reserve));    //Blocs de taille croissante
+    void *p = ar->blocs[ar->numBlocs - 1] + ar->pos;
+    ar->pos += taille;
+    ar->allocations++;
+    ar->octets += taille;
+    return p;
+}
+
+
+/**
+ * @brief   Libère tous les blocs de l'arène (les compteurs sont gardés pour les rapports).
+ */
+void arenaLiberer(Arena *ar)
+{
+    compterAllocation(ar->octets - ar->comptes);    //Nœuds rendus depuis la dernière libération
+    ar->comptes = ar->octets;
+    for (int i = 0; i < ar->numBlocs; i++)
+        free(ar->blocs[i]);
+    free(ar->blocs);
+    free(ar->tailles);
+    ar->blocs = NULL;
+    ar->tailles = NULL;
+    ar->numBlocs = ar->capBlocs = 0;
+    ar->pos = 0;
+    ar->reserve = 0;
+}
+
+
+__thread Arena arenaAVL;    //Nœuds de l'arbre de triAVL
+
+
+// paires duales
+
+/**
+ * @brief   Vide un tableau de paires et lui donne la place d'au moins cap arêtes duales.
+ * @param   p   Tableau de paires (gardé d'un appel à l'autre)
+ * @param   cap Nombre de paires attendu
+ */
+void reserverPaires(PairesD *p, int cap)
+{
+    if (cap > p->cap)
+    {
+        p->f = reallouer(p->f, sizeof(int) * 2 * (size_t)p->cap, sizeof(int) * 2 * (size_t)cap);
+        p->cap = cap;
+    }
+    p->num = 0;
+}
+
+
+/**
+ * @brief   Ajoute une arête duale à la suite du tableau (agrandi si la réserve ne suffit pas).
+ * @param   f1 Numéro de la première face
+ * @param   f2 Numéro de la deuxième face
+ */
+static inline void ajouterPaire(PairesD *p, int f1, int f2)
+{
+    if (p->num == p->cap)
+    {
+        size_t avant = sizeof(int) * 2 * (size_t)p->cap;
+        p->cap = max(16, 2 * p->cap);
+        p->f = reallouer(p->f, avant, sizeof(int) * 2 * (size_t)p->cap);
+    }
+    p->f[2 * p->num] = f1;
+    p->f[2 * p->num + 1] = f2;
+    p->num++;
+}
+
+
+void libererPaires(PairesD *p)
+{
+    free(p->f);
+    p->f = NULL;
+    p->num = p->cap = 0;
+}
+
+
+/**
+ * @brief   Vérifie que deux tableaux d'arêtes duales sont identiques (mêmes paires, même ordre).
+ * @return  1 si identiques, 0 sinon
+ */
+int memesPaires(const PairesD *p1, const PairesD *p2)
+{
+    return p1->num == p2->num && memcmp(p1->f, p2->f, sizeof(int) * 2 * (size_t)p1->num) == 0;
+}
+
+
+
+// tri selection
+
+/**
+ * @brief   Apparie une suite d'arêtes identiques, prise dans un tableau trié
+ *
+ * Deux faces : une arête duale, comme avant. Trois faces ou plus (arête non manifold) :
+ * la face rencontrée en premier (plus petit numéro) est reliée à chacune des autres, comme
+ * le font triAVL et triHash, au lieu d'une chaîne qui dépend de l'ordre du tri.
+ *
+ * @param   suite   Arêtes identiques
+ * @param   n       Longueur de la suite
+ * @param   paires  Arêtes équivalentes, complétées à la suite
+ */
+void apparierSuite(Arete *suite, int n, PairesD *paires)
+{
+    if (n == 2)
+    {
+        ajouterPaire(paires, suite[0].faceA, suite[1].faceA);
+        return;
+    }
+    int centre = 0;
+    for (int i = 1; i < n; i++)
+        if (suite[i].faceA < suite[centre].faceA)
+            centre = i;
+    for (int i = 0; i < n; i++)
+    {
+        if (i == centre)
+            continue;
+        ajouterPaire(paires, suite[centre].faceA, suite[i].faceA);
+    }
+}
+
+/**
+ * @brief   Trie les arêtes par sélection
+ * @param   aretes   Tableau des arêtes
+ * @param   numEdges Nombre d'arêtes
+ * @param   paires   Arêtes équivalentes, ajoutées à la suite
+ */
+void triSelection(Arete *aretes, int numEdges, PairesD *paires)
+{
+
+    for (int i = 0; i < numEdges - 1; i++)
+    {
+        int minIndex = i;
+
+        for (int j = i + 1; j < numEdges; j++)
+        {
+            if (estSuperieureA(aretes[j], aretes[minIndex]) < 0)
+            {
+                minIndex = j;
+            }
+        }
+
+        Arete temp = aretes[i];
+        aretes[i] = aretes[minIndex];
+        aretes[minIndex] = temp;
+    }
+
+    for (int i = 0; i < numEdges - 1;)
+    {
+        // printf("%d 1: %d %d    2: %d %d\n", i, aretes[i].num1,aretes[i].num2, aretes[i+1].num1,aretes[i+1].num2);
+        int fin = i + 1;
+        while (fin < numEdges && sontEquivalentes(aretes[i], aretes[fin]))   //Suite des arêtes identiques
+            fin++;
+        if (fin - i > 1)
+            apparierSuite(aretes + i, fin - i, paires);
+        i = fin;
+    }
+}
+
+
+// tas sort
+
+/**
+ * @brief   Réorganise le tableau en tas à partir de l'indice spécifié.
+ *
+ * @param   aretes  Tableau d'arêtes
+ * @param   n       Taille du tableau
+ * @param   i       Indice à partir duquel réorganiser le tableau en tas
+ */
+void heapify(Arete *aretes, int n, int i)
+{
+    int largest = i;    //Initialisation de l'indice du plus grand élément, du fils gauche et du fils droit
+    int left = 2 * i + 1;
+    int right = 2 * i + 2;
+
+    if (left < n && estSuperieureA(aretes[left], aretes[largest]) > 0)     //Vérifie si le fils gauche est plus grand que le plus grand élément actuel
+        largest = left;
+
+    if (right < n && estSuperieureA(aretes[right], aretes[largest]) > 0)
+        largest = right;
+
+    if (largest != i)   //Si le plus grand élément n'est pas à l'indice d'origine, échange les éléments et continue la réorganisation
+    {
+        Arete temp = aretes[i];
+        aretes[i] = aretes[largest];
+        aretes[largest] = temp;
+
+        heapify(aretes, n, largest);
+    }
+}
+
+
+/**
+ * @brief   Construit un tas à partir du tableau d'arêtes.
+ *
+ * @param   aretes  Tableau d'arêtes
+ * @param   n       Taille du tableau
+ */
+void buildHeap(Arete *aretes, int n)
+{
+    for (int i = n / 2 - 1; i >= 0; i--)   //Parcours du tableau d'arêtes à partir du milieu
+        heapify(aretes, n, i);
+}
+
+
+/**
+ * @brief   Trie les arêtes par tas
+ * @param   aretes   Tableau des arêtes
+ * @param   numEdges Nombre d'arêtes
+ * @param   paires   Arêtes équivalentes, ajoutées à la suite
+ */
+void triTas(Arete *aretes, int numEdges, PairesD *paires)
+{
+
+    buildHeap(aretes, numEdges); //Peut être placé dans la main
+
+    for (int i = numEdges - 1; i > 0; i--)
+    {
+        Arete temp = aretes[0];     //Échange l'élément le plus grand avec le dernier élément non trié
+        aretes[0] = aretes[i];
+        aretes[i] = temp;
+
+        heapify(aretes, i, 0);
+    }
+
+    for (int k = 0; k < numEdges - 1;)
+    {
+        int fin = k + 1;
+        while (fin < numEdges && sontEquivalentes(aretes[k], aretes[fin]))  //Les côtés identiques sont toujours adjacents.
+            fin++;
+        if (fin - k > 1)
+            apparierSuite(aretes + k, fin - k, paires);
+        k = fin;
+    }
+}
+
+
+// AVL
+
+/**
+ * @brief   Hauteur de l'arbre AVL à partir du nœud spécifié (une feuille a la hauteur 1).
+ * @param   a   Nœud de l'arbre AVL
+ * @return  La hauteur de l'arbre AVL, 0 pour un arbre vide
+ */
+int treeHeight(AreteAVL *a)
+{
+    if (a == NULL)
+        return 0;
+
+    return a->hauteur;
+}
+
+
+/**
+ * @brief   Calcule le facteur d'équilibre d'un nœud dans un arbre AVL.
+ *
+ * Un sous-arbre vide compte pour une hauteur 0 : un nœud qui n'a qu'un fils est donc bien
+ * vu comme déséquilibré si ce fils a lui-même un enfant.
+ *
+ * @param   a   Nœud de l'arbre AVL
+ * @return  Le facteur d'équilibre du nœud (différence de hauteur entre le sous-arbre gauche et le sous-arbre droit)
+ */
+int balanceP(AreteAVL *a)
+{
+    if (a == NULL)
+        return 0;
+
+    return treeHeight(a->left) - treeHeight(a->right);
+}
+
+
+/**
+ * @brief   Effectue une rotation droite pour rééquilibrer un nœud dans un arbre AVL.
+ *
+ * @param   t   Nœud à rééquilibrer
+ * @return  Nouveau nœud après la rotation
+ */
+AreteAVL *rotaD(AreteAVL *t)
+{
+    AreteAVL *left = t->left;
+
+    compteurRotations++;
+    t->left = left->right;
+    left->right = t;
+
+    left->hauteur = max(treeHeight(left->left), treeHeight(left->right)) + 1;  //Met à jour les hauteurs après la rotation
+    t->hauteur = max(treeHeight(t->left), treeHeight(t->right)) + 1;
+
+    return left;
+}
+
+AreteAVL *rotaG(AreteAVL *t)   //Pareil comme avant
+{
+    AreteAVL *right = t->right;
+
+    compteurRotations++;
+    t->right = right->left;
+    right->left = t;
+
+    right->hauteur = max(treeHeight(right->left), treeHeight(right->right)) + 1;
+    t->hauteur = max(treeHeight(t->left), treeHeight(t->right)) + 1;
+
+    return right;
+}
+
+
+/**
+ * @brief   Rééquilibre un nœud dans un arbre AVL après une opération d'insertion ou de suppression.
+ *
+ * @param   a   Nœud à rééquilibrer
+ * @return  Nouveau nœud après la rééquilibrage
+ */
+AreteAVL *treeRebalance(AreteAVL *a)
+{
+    int factor = balanceP(a);    //Calcule le facteur d'équilibre du nœud
+    if (factor > 1)    //Si le facteur d'équilibre est supérieur à 1, un déséquilibre à gauche est détecté
+    {
+        if (balanceP(a->left) >= 0) //LL
+            return rotaD(a);
+        else //LR
+        {
+            a->left = rotaG(a->left);
+            return rotaD(a);
+        }
+    }
+    else if (factor < -1)
+    {
+        if (balanceP(a->right) <= 0) //RR
+            return rotaG(a);
+        else //RL
+        {
+            a->right = rotaD(a->right);
+            return rotaG(a);
+        }
+    }
+    else 
+    {
+        a->hauteur = max(treeHeight(a->left), treeHeight(a->right)) + 1;
+        return a;
+    }
+}
+
+
+/**
+ * @brief   Vérifie si un nœud dans un arbre AVL est équivalent à nœud on veut insert.
+ *
+ * @param   a1      Nœud à vérifier
+ * @param   num1    Premier numéro du sommet
+ * @param   num2    Deuxième numéro du sommet
+ * @return  1 si le nœud est équivalent au couple de numéros, sinon 0
+ */
+int sontEquivalentesA(AreteAVL *a1, int num1, int num2)
+{
+    if ((a1->num1 == num1) && (a1->num2 == num2))
+        return 1;
+    return 0;
+}
+
+int estSuperieureAVL(AreteAVL *a, int num1, int num2)
+{
+    if (a->num1 == num1)
+        return a->num2 - num2;
+    return a->num1 - num1;
+}
+
+
+/**
+ * @brief   Crée un nouveau nœud pour un arbre AVL.
+ *
+ * @param   num1    Premier sommet
+ * @param   num2    Deuxième sommet
+ * @param   faceA   Numéro de la face associée au nœud
+ * @return  Nouveau nœud alloué dynamiquement
+ */
+AreteAVL *createNode(int num1, int num2, int faceA)
+{
+    AreteAVL *newNode = arenaAlloc(&arenaAVL, sizeof(AreteAVL));
+    newNode->num1 = num1;
+    newNode->num2 = num2;
+    newNode->left = newNode->right = NULL;
+    newNode->faceA = faceA;
+    newNode->hauteur = 1;
+
+    return newNode;
+}
+
+
+/**
+ * @brief   Insère un nouveau nœud dans un arbre AVL et détecte les arêtes équivalentes.
+ *
+ * @param   a       Racine de l'arbre AVL
+ * @param   num1    Premier sommet du nouveau nœud
+ * @param   num2    Deuxième sommet du nouveau nœud
+ * @param   faceA   Numéro de la face associée au nouveau nœud
+ * @return  Face du nœud équivalent déjà présent (arête duale détectée), -1 sinon
+ */
+int treeInsert(AreteAVL **a, int num1, int num2, int faceA)
+{
+    AreteAVL *treeRoot = *a;  //Récupère la racine de l'arbre AVL
+    if (treeRoot == NULL)
+    {
+        *a = createNode(num1, num2, faceA);   //Si l'arbre est vide, crée un nouveau nœud à la racine
+        return -1;
+    }
+    else if (sontEquivalentesA(treeRoot, num1, num2))   // Si le nouveau nœud est équivalent à la racine, détecte les arêtes équivalentes
+    {
+        return treeRoot->faceA;
+    }
+    else   //Si le nouveau nœud n'est pas équivalent à la racine, effectue l'insertion récursive
+    {
+        int equivalentEdgesList = -1;
+
+        if (estSuperieureAVL(treeRoot, num1, num2) < 0)   //Si nouveau nœud plus grande que racine
+        {
+            equivalentEdgesList = treeInsert(&(treeRoot->right), num1, num2, faceA);   //Insert à droite
+            treeRoot->right = treeRebalance(treeRoot->right);
+        }
+        else       //Si nouveau nœud plus petite que racine
+        {
+            equivalentEdgesList = treeInsert(&(treeRoot->left), num1, num2, faceA);    //Insert à gauche
+            treeRoot->left = treeRebalance(treeRoot->left);
+        }
+
+        treeRoot = treeRebalance(treeRoot);
+        *a = treeRoot;
+        return equivalentEdgesList;    //Retourne la face équivalente détectée pendant l'insertion
+    }
+}
+
+
+/**
+ * @brief   Trie les arêtes par AVL
+ * @param   a        Tableau des arêtes
+ * @param   n        Nombre d'arêtes
+ * @param   paires   Arêtes équivalentes, ajoutées à la suite
+ */
+void triAVL(Arete *a, int n, PairesD *paires)
+{
+    AreteAVL *newTree = NULL;    //Initialise l'arbre AVL à NULL
+
+    arenaReserver(&arenaAVL, (size_t)n * sizeof(AreteAVL));    //Au plus un nœud par arête, contigus
+    for (int i = 0; i < n; i++)
+    {
+        int face = treeInsert(&newTree, a[i].num1, a[i].num2, a[i].faceA);    //Insère le nœud correspondant à l'arête
+        if (face >= 0)    //Si une arête équivalente est détectée, ajoute la paire
+            ajouterPaire(paires, face, a[i].faceA);
+    }
+
+    arenaLiberer(&arenaAVL);    //Tout l'arbre en un appel
+}
+
+
+// table de hachage
+
+/**
+ * @brief   Regroupe les deux sommets d'une arête en une seule clé 64 bits.
+ *
+ * num1 occupe les 32 bits de poids fort, num2 ceux de poids faible : l'ordre des clés
+ * est donc le même que celui de estSuperieureA.
+ *
+ * @param   a   Arête (num1 <= num2, comme produit par generalise)
+ * @return  La clé de l'arête
+ */
+uint64_t cleArete(Arete a)
+{
+    return ((uint64_t)(uint32_t)a.num1 << 32) | (uint32_t)a.num2;
+}
+
+
+/**
+ * @brief   Mélange une clé d'arête pour l'indexer dans la table (hachage de Fibonacci).
+ * @param   cle     Clé de l'arête
+ * @param   bits    Nombre de bits de l'indice (capacité = 2^bits)
+ * @return  Indice de la case de départ
+ */
+size_t hashArete(uint64_t cle, int bits)
+{
+    cle ^= cle >> 29;
+    return (size_t)((cle * 0x9E3779B97F4A7C15ULL) >> (64 - bits));
+}
+
+
+/**
+ * @brief   Apparie les arêtes avec une table de hachage à adressage ouvert (sondage linéaire)
+ *
+ * Chaque arête est cherchée dans la table : si la clé y est déjà, on crée l'arête duale
+ * (face déjà stockée, face courante), sinon on l'insère. C'est exactement ce que fait
+ * treeInsert, les paires obtenues sont donc identiques à celles de triAVL, en O(n) attendu.
+ *
+ * @param   aretes   Tableau des arêtes
+ * @param   numEdges Nombre d'arêtes
+ * @param   paires   Arêtes équivalentes, ajoutées à la suite
+ */
+void triHash(Arete *aretes, int numEdges, PairesD *paires)
+{
+
+    int bits = 4;
+    while (((size_t)1 << bits) < (size_t)numEdges * 2)   //Facteur de charge <= 0.5
+        bits++;
+    size_t capacite = (size_t)1 << bits;
+    size_t masque = capacite - 1;
+
+    AreteCle *table = allouer(capacite * sizeof(AreteCle));
+    for (size_t i = 0; i < capacite; i++)
+        table[i].faceA = -1;
+
+    for (int i = 0; i < numEdges; i++)
+    {
+        uint64_t cle = cleArete(aretes[i]);
+        size_t h = hashArete(cle, bits);
+
+        while (table[h].faceA != -1 && table[h].cle != cle)   //Sondage linéaire jusqu'à la clé ou une case vide
+            h = (h + 1) & masque;
+
+        if (table[h].faceA == -1)
+        {
+            table[h].cle = cle;
+            table[h].faceA = aretes[i].faceA;
+        }
+        else
+            ajouterPaire(paires, table[h].faceA, aretes[i].faceA);
+    }
+
+    free(table);
+}
+
+
+// B+-arbre
+
+#define BARBRE_ORDRE 32     //Clés par nœud : 256 octets de clés, lues d'un trait
+
+__thread Arena arenaBArbre;    //Nœuds de triBArbre
+
+typedef struct bnoeud
+{
+    int n;                          //Nombre de clés
+    int feuille;
+    uint64_t cles[BARBRE_ORDRE];
+} BNoeud;
+
+typedef struct bfeuille
+{
+    BNoeud h;
+    int faces[BARBRE_ORDRE];
+    struct bfeuille *suivante;      //Feuilles chaînées dans l'ordre des clés
+} BFeuille;
+
+typedef struct binterne
+{
+    BNoeud h;                       //L'enfant i contient les clés de cles[i - 1] (inclus) à cles[i] (exclu)
+    BNoeud *enfants[BARBRE_ORDRE + 1];
+} BInterne;
+
+
+static BFeuille *nouvelleFeuille(void)
+{
+    BFeuille *f = arenaAlloc(&arenaBArbre, sizeof(BFeuille));
+    f->h.n = 0;
+    f->h.feuille = 1;
+    f->suivante = NULL;
+    return f;
+}
+
+static BInterne *nouveauInterne(void)
+{
+    BInterne *x = arenaAlloc(&arenaBArbre, sizeof(BInterne));
+    x->h.n = 0;
+    x->h.feuille = 0;
+    return x;
+}
+
+
+/**
+ * @brief   Insère une clé dans le B+-arbre, sans récursion : le chemin depuis la racine est
+ *          gardé dans une pile, puis les éclatements remontent le long de ce chemin.
+ *
+ * @param   racine  Racine de l'arbre (peut changer si la racine éclate)
+ * @param   cle     Clé de l'arête
+ * @param   faceA   Face associée
+ * @return  La face déjà stockée si la clé existait (rien n'est inséré), -1 sinon
+ */
+int bArbreInserer(BNoeud **racine, uint64_t cle, int faceA)
+{
+    BInterne *chemin[64];
+    int pos[64];
+    int prof = 0;
+
+    BNoeud *x = *racine;
+    while (!x->feuille)
+    {
+        int i = 0;
+        while (i < x->n && x->cles[i] <= cle)
+            i++;
+        chemin[prof] = (BInterne *)x;
+        pos[prof] = i;
+        prof++;
+        x = ((BInterne *)x)->enfants[i];
+    }
+
+    BFeuille *f = (BFeuille *)x;
+    int i = 0;
+    while (i < f->h.n && f->h.cles[i] < cle)
+        i++;
+    if (i < f->h.n && f->h.cles[i] == cle)
+        return f->faces[i];
+
+    if (f->h.n < BARBRE_ORDRE)
+    {
+        memmove(&f->h.cles[i + 1], &f->h.cles[i], (f->h.n - i) * sizeof(uint64_t));
+        memmove(&f->faces[i + 1], &f->faces[i], (f->h.n - i) * sizeof(int));
+        f->h.cles[i] = cle;
+        f->faces[i] = faceA;
+        f->h.n++;
+        return -1;
+    }
+
+    //Feuille pleine : les ORDRE + 1 clés sont partagées entre elle et une nouvelle feuille à droite
+    uint64_t cles[BARBRE_ORDRE + 1];
+    int faces[BARBRE_ORDRE + 1];
+    memcpy(cles, f->h.cles, i * sizeof(uint64_t));
+    memcpy(faces, f->faces, i * sizeof(int));
+    cles[i] = cle;
+    faces[i] = faceA;
+    memcpy(cles + i + 1, f->h.cles + i, (BARBRE_ORDRE - i) * sizeof(uint64_t));
+    memcpy(faces + i + 1, f->faces + i, (BARBRE_ORDRE - i) * sizeof(int));
+
+    int gauche = (BARBRE_ORDRE + 1) / 2;
+    BFeuille *droite = nouvelleFeuille();
+    f->h.n = gauche;
+    memcpy(f->h.cles, cles, gauche * sizeof(uint64_t));
+    memcpy(f->faces, faces, gauche * sizeof(int));
+    droite->h.n = BARBRE_ORDRE + 1 - gauche;
+    memcpy(droite->h.cles, cles + gauche, droite->h.n * sizeof(uint64_t));
+    memcpy(droite->faces, faces + gauche, droite->h.n * sizeof(int));
+    droite->suivante = f->suivante;
+    f->suivante = droite;
+
+    uint64_t separateur = droite->h.cles[0];
+    BNoeud *nouveau = &droite->h;
+
+    while (prof > 0)    //Remonte le séparateur, en éclatant les nœuds internes pleins
+    {
+        prof--;
+        BInterne *p = chemin[prof];
+        int k = pos[prof];
+
+        if (p->h.n < BARBRE_ORDRE)
+        {
+            memmove(&p->h.cles[k + 1], &p->h.cles[k], (p->h.n - k) * sizeof(uint64_t));
+            memmove(&p->enfants[k + 2], &p->enfants[k + 1], (p->h.n - k) * sizeof(BNoeud *));
+            p->h.cles[k] = separateur;
+            p->enfants[k + 1] = nouveau;
+            p->h.n++;
+            return -1;
+        }
+
+        uint64_t pc[BARBRE_ORDRE + 1];
+        BNoeud *pe[BARBRE_ORDRE + 2];
+        memcpy(pc, p->h.cles, k * sizeof(uint64_t));
+        pc[k] = separateur;
+        memcpy(pc + k + 1, p->h.cles + k, (BARBRE_ORDRE - k) * sizeof(uint64_t));
+        memcpy(pe, p->enfants, (k + 1) * sizeof(BNoeud *));
+        pe[k + 1] = nouveau;
+        memcpy(pe + k + 2, p->enfants + k + 1, (BARBRE_ORDRE - k) * sizeof(BNoeud *));
+
+        int milieu = (BARBRE_ORDRE + 1) / 2;    //pc[milieu] monte au parent
+        BInterne *d = nouveauInterne();
+        p->h.n = milieu;
+        memcpy(p->h.cles, pc, milieu * sizeof(uint64_t));
+        memcpy(p->enfants, pe, (milieu + 1) * sizeof(BNoeud *));
+        d->h.n = BARBRE_ORDRE - milieu;
+        memcpy(d->h.cles, pc + milieu + 1, d->h.n * sizeof(uint64_t));
+        memcpy(d->enfants, pe + milieu + 1, (d->h.n + 1) * sizeof(BNoeud *));
+
+        separateur = pc[milieu];
+        nouveau = &d->h;
+    }
+
+    BInterne *r = nouveauInterne();    //La racine a éclaté : l'arbre grandit d'un niveau
+    r->h.n = 1;
+    r->h.cles[0] = separateur;
+    r->enfants[0] = *racine;
+    r->enfants[1] = nouveau;
+    *racine = &r->h;
+    return -1;
+}
+
+
+/**
+ * @brief   Trie les arêtes avec un B+-arbre à nœuds larges
+ *
+ * Même principe que triAVL (première face gardée, les suivantes donnent l'arête duale), donc
+ * mêmes paires, mais chaque nœud tient 32 clés contiguës : quelques niveaux suffisent et les
+ * comparaisons se font dans des lignes de cache déjà chargées. Les feuilles sont chaînées
+ * dans l'ordre des clés.
+ *
+ * @param   aretes   Tableau des arêtes
+ * @param   numEdges Nombre d'arêtes
+ * @param   paires   Arêtes équivalentes, ajoutées à la suite
+ */
+void triBArbre(Arete *aretes, int numEdges, PairesD *paires)
+{
+
+    arenaReserver(&arenaBArbre, (size_t)(numEdges / (BARBRE_ORDRE / 2) + 2) * sizeof(BFeuille));
+    BNoeud *racine = &nouvelleFeuille()->h;
+
+    for (int i = 0; i < numEdges; i++)
+    {
+        int face = bArbreInserer(&racine, cleArete(aretes[i]), aretes[i].faceA);
+        if (face >= 0)
+            ajouterPaire(paires, face, aretes[i].faceA);
+    }
+
+    arenaLiberer(&arenaBArbre);
+}
+
+// tri radix
+
+#define RADIX_BITS 11
+#define RADIX_TAILLE (1 << RADIX_BITS)
+
+/**
+ * @brief   Trie des clés d'arêtes par tri radix LSD (chiffres de 11 bits), stable.
+ *
+ * Les passes dont le chiffre est le même pour toutes les clés sont sautées.
+ *
+ * @param   cles    Tableau à trier
+ * @param   tmp     Tableau de travail de même taille
+ * @param   n       Nombre de clés
+ * @param   bits    Nombre de bits significatifs des clés
+ * @return  Le tableau (cles ou tmp) qui contient le résultat trié
+ */
+AreteCle *trierRadixCles(AreteCle *cles, AreteCle *tmp, int n, int bits)
+{
+    size_t compte[RADIX_TAILLE];
+
+    for (int decalage = 0; decalage < bits; decalage += RADIX_BITS)
+    {
+        memset(compte, 0, sizeof(compte));
+        for (int i = 0; i < n; i++)     //Histogramme du chiffre courant
+            compte[(cles[i].cle >> decalage) & (RADIX_TAILLE - 1)]++;
+
+        if (compte[(cles[0].cle >> decalage) & (RADIX_TAILLE - 1)] == (size_t)n)
+            continue;   //Toutes les clés ont ce chiffre, rien à déplacer
+
+        size_t somme = 0;
+        for (int d = 0; d < RADIX_TAILLE; d++)   //Préfixe : position de départ de chaque chiffre
+        {
+            size_t c = compte[d];
+            compte[d] = somme;
+            somme += c;
+        }
+
+        for (int i = 0; i < n; i++)
+            tmp[compte[(cles[i].cle >> decalage) & (RADIX_TAILLE - 1)]++] = cles[i];
+
+        AreteCle *t = cles;
+        cles = tmp;
+        tmp = t;
+    }
+
+    return cles;
+}
+
+
+/**
+ * @brief   Trie les arêtes par tri radix sur leurs clés 64 bits
+ *
+ * Chaque arête devient une clé (num1, num2) compacte, sur juste assez de bits pour le plus
+ * grand indice de sommet, accompagnée de sa face. Le tri est stable : pour une arête partagée,
+ * la première face rencontrée reste en tête, comme dans triAVL.
+ *
+ * @param   aretes   Tableau des arêtes
+ * @param   numEdges Nombre d'arêtes
+ * @param   paires   Arêtes équivalentes, ajoutées à la suite
+ */
+void triRadix(Arete *aretes, int numEdges, PairesD *paires)
+{
+    if (numEdges <= 0)
+        return;
+
+    uint32_t maxNum = 0;
+    for (int i = 0; i < numEdges; i++)
+    {
+        maxNum = max(maxNum, (uint32_t)aretes[i].num1);
+        maxNum = max(maxNum, (uint32_t)aretes[i].num2);
+    }
+    int bitsNum = 1;
+    while (bitsNum < 32 && (maxNum >> bitsNum) != 0)
+        bitsNum++;
+
+    AreteCle *cles = allouer(numEdges * sizeof(AreteCle));
+    AreteCle *tmp = allouer(numEdges * sizeof(AreteCle));
+    for (int i = 0; i < numEdges; i++)
+    {
+        cles[i].cle = ((uint64_t)(uint32_t)aretes[i].num1 << bitsNum) | (uint32_t)aretes[i].num2;
+        cles[i].faceA = aretes[i].faceA;
+    }
+
+    AreteCle *trie = trierRadixCles(cles, tmp, numEdges, 2 * bitsNum);
+
+    for (int k = 0; k < numEdges - 1; k++)
+    {
+        int premiere = k;   //Tri stable : la première face de la suite est la plus ancienne
+        while (k < numEdges - 1 && trie[k].cle == trie[k + 1].cle)  //Les côtés identiques sont toujours adjacents.
+        {
+            ajouterPaire(paires, trie[premiere].faceA, trie[k + 1].faceA);
+            k++;
+        }
+    }
+
+    free(cles);
+    free(tmp);
+}
+
+
+// groupes d'arêtes
+
+/**
+ * @brief   Arêtes du maillage regroupées par clé : chaque groupe liste, dans l'ordre du
+ *          tableau d'entrée, les arêtes (donc les faces) qui partagent la même arête.
+ */
+typedef struct groupesAretes
+{
+    int numGroupes;
+    int *debut;         //Groupe k : indices[debut[k]] ... indices[debut[k + 1] - 1]
+    int *indices;       //Indices dans le tableau des arêtes
+    int bord;           //Arêtes d'une seule face
+    int variete;        //Arêtes partagées par deux faces
+    int nonVariete;     //Arêtes partagées par trois faces ou plus
+    int maxFaces;
+} GroupesAretes;
+
+
+/**
+ * @brief   Regroupe les arêtes identiques, quel que soit le nombre de faces qui les partagent
+ *          (tri radix stable sur les clés, l'indice de l'arête voyage avec la clé)
+ * @param   aretes   Tableau des arêtes
+ * @param   numEdges Nombre d'arêtes
+ * @return  Groupes (à libérer avec libererGroupes)
+ */
+GroupesAretes *grouperAretes(Arete *aretes, int numEdges)
+{
+    GroupesAretes *gr = calloc(1, sizeof(GroupesAretes));
+    gr->debut = allouer(sizeof(int) * (numEdges + 1));
+    gr->indices = allouer(sizeof(int) * max(numEdges, 1));
+    gr->debut[0] = 0;
+    if (numEdges <= 0)
+        return gr;
+
+    uint32_t maxNum = 0;
+    for (int i = 0; i < numEdges; i++)
+        maxNum = max(maxNum, (uint32_t)aretes[i].num2);
+    int bitsNum = 1;
+    while (bitsNum < 32 && (maxNum >> bitsNum) != 0)
+        bitsNum++;
+
+    AreteCle *cles = allouer(numEdges * sizeof(AreteCle));
+    AreteCle *tmp = allouer(numEdges * sizeof(AreteCle));
+    for (int i = 0; i < numEdges; i++)
+    {
+        cles[i].cle = ((uint64_t)(uint32_t)aretes[i].num1 << bitsNum) | (uint32_t)aretes[i].num2;
+        cles[i].faceA = i;
+    }
+    AreteCle *trie = trierRadixCles(cles, tmp, numEdges, 2 * bitsNum);
+
+    for (int k = 0; k < numEdges;)
+    {
+        int fin = k + 1;
+        while (fin < numEdges && trie[fin].cle == trie[k].cle)
+            fin++;
+        for (int i = k; i < fin; i++)
+            gr->indices[i] = trie[i].faceA;
+        gr->debut[++gr->numGroupes] = fin;
+
+        int n = fin - k;
+        if (n == 1)
+            gr->bord++;
+        else if (n == 2)
+            gr->variete++;
+        else
+            gr->nonVariete++;
+        gr->maxFaces = max(gr->maxFaces, n);
+        k = fin;
+    }
+
+    free(cles);
+    free(tmp);
+    return gr;
+}
+
+void libererGroupes(GroupesAretes *gr)
+{
+    free(gr->debut);
+    free(gr->indices);
+    free(gr);
+}
+
+
+/**
+ * @brief   Apparie les arêtes à partir des groupes : dans chaque groupe, la première face
+ *          est reliée à toutes les autres. Les paires sont remises dans l'ordre où triHash
+ *          les découvre (position de la deuxième arête), le tableau est donc identique.
+ *
+ * @param   aretes   Tableau des arêtes
+ * @param   numEdges Nombre d'arêtes
+ * @param   paires   Arêtes équivalentes, ajoutées à la suite
+ */
+void triGroupes(Arete *aretes, int numEdges, PairesD *paires)
+{
+    GroupesAretes *gr = grouperAretes(aretes, numEdges);
+
+    int *premiere = allouer(sizeof(int) * max(numEdges, 1));    //Pour chaque arête : première face de son groupe
+    for (int k = 0; k < gr->numGroupes; k++)
+    {
+        int p = aretes[gr->indices[gr->debut[k]]].faceA;
+        premiere[gr->indices[gr->debut[k]]] = -1;
+        for (int i = gr->debut[k] + 1; i < gr->debut[k + 1]; i++)
+            premiere[gr->indices[i]] = p;
+    }
+    for (int i = 0; i < numEdges; i++)
+    {
+        if (premiere[i] != -1)
+            ajouterPaire(paires, premiere[i], aretes[i].faceA);
+    }
+
+    free(premiere);
+    libererGroupes(gr);
+}
+
+
+// tri parallèle
+
+
+/**
+ * @brief   Fusion stable de deux suites triées (à clé égale, a passe avant b)
+ * @param   a, na   Première suite
+ * @param   b, nb   Deuxième suite
+ * @param   out     Tableau de sortie (na + nb cases)
+ */
+void fusionnerIdx(AreteIdx *a, int na, AreteIdx *b, int nb, AreteIdx *out)
+{
+    int i = 0, j = 0, k = 0;
+    while (i < na && j < nb)
+        out[k++] = (b[j].cle < a[i].cle) ? b[j++] : a[i++];
+    while (i < na)
+        out[k++] = a[i++];
+    while (j < nb)
+        out[k++] = b[j++];
+}
+
+
+/**
+ * @brief   Tri fusion stable de bas en haut (insertion sur des blocs de 32 pour commencer)
+ * @param   t       Tableau à trier
+ * @param   tmp     Tableau de travail de même taille
+ * @param   n       Taille du tableau
+ */
+void trierFusionIdx(AreteIdx *t, AreteIdx *tmp, int n)
+{
+    for (int debut = 0; debut < n; debut += 32)
+    {
+        int fin = min(debut + 32, n);
+        for (int i = debut + 1; i < fin; i++)
+        {
+            AreteIdx x = t[i];
+            int j = i - 1;
+            while (j >= debut && t[j].cle > x.cle)
+            {
+                t[j + 1] = t[j];
+                j--;
+            }
+            t[j + 1] = x;
+        }
+    }
+
+    AreteIdx *src = t, *dst = tmp;
+    for (int largeur = 32; largeur < n; largeur *= 2)
+    {
+        for (int i = 0; i < n; i += 2 * largeur)
+        {
+            int milieu = min(i + largeur, n);
+            int fin = min(i + 2 * largeur, n);
+            fusionnerIdx(src + i, milieu - i, src + milieu, fin - milieu, dst + i);
+        }
+        AreteIdx *x = src;
+        src = dst;
+        dst = x;
+    }
+
+    if (src != t)
+        memcpy(t, src, n * sizeof(AreteIdx));
+}
+
+
+/**
+ * @brief   Co-rang : nombre d'éléments de a parmi les k premiers de la fusion stable de a et b.
+ *
+ * Permet de couper une fusion en morceaux indépendants, un par thread.
+ */
+int coRang(int k, AreteIdx *a, int na, AreteIdx *b, int nb)
+{
+    int lo = max(0, k - nb);
+    int hi = min(k, na);
+    while (lo < hi)
+    {
+        int i = (lo + hi) / 2;
+        int j = k - i;
+        if (j > 0 && a[i].cle <= b[j - 1].cle)   //a[i] sort avant b[j-1] : i est trop petit
+            lo = i + 1;
+        else
+            hi = i;
+    }
+    return lo;
+}
+
+
+typedef struct contexteParallele
+{
+    Arete *aretes;
+    int n;
+    int nbT;
+    AreteIdx *t0, *t1;
+    AreteIdx *trie;        //Celui de t0/t1 qui contient le résultat du tri
+    int *premier;          //premier[i] : indice de la première occurrence de l'arête i, -1 si c'est elle
+    pthread_barrier_t barriere;
+} ContexteParallele;
+
+typedef struct threadParallele
+{
+    ContexteParallele *ctx;
+    int id;
+} ThreadParallele;
+
+
+/**
+ * @brief   Travail d'un thread : clés et tri de sa tranche, tours de fusion, puis recherche
+ *          des arêtes équivalentes dans sa part du tableau trié.
+ */
+void *travailParallele(void *arg)
+{
+    ThreadParallele *th = arg;
+    ContexteParallele *ctx = th->ctx;
+    int n = ctx->n;
+    int nbT = ctx->nbT;
+#define BORNE(c) ((int)((long long)n * (c) / nbT))   //Début de la tranche c
+    int x0 = BORNE(th->id);
+    int x1 = BORNE(th->id + 1);
+
+    for (int i = x0; i < x1; i++)
+    {
+        ctx->t0[i].cle = cleArete(ctx->aretes[i]);
+        ctx->t0[i].indice = i;
+    }
+    trierFusionIdx(ctx->t0 + x0, ctx->t1 + x0, x1 - x0);
+    pthread_barrier_wait(&ctx->barriere);
+
+    //À chaque tour, les suites de largeur tranches sont fusionnées deux à deux ; chaque thread
+    //écrit la partie [x0, x1) de la sortie, quelle que soit la paire à laquelle elle appartient.
+    AreteIdx *src = ctx->t0, *dst = ctx->t1;
+    for (int largeur = 1; largeur < nbT; largeur *= 2)
+    {
+        for (int c = 0; c < nbT; c += 2 * largeur)
+        {
+            int debut = BORNE(c);
+            int milieu = BORNE(min(c + largeur, nbT));
+            int fin = BORNE(min(c + 2 * largeur, nbT));
+            if (fin <= x0 || debut >= x1)
+                continue;
+
+            int k0 = max(x0, debut) - debut;
+            int k1 = min(x1, fin) - debut;
+            int na = milieu - debut, nb = fin - milieu;
+            int i0 = coRang(k0, src + debut, na, src + milieu, nb);
+            int i1 = coRang(k1, src + debut, na, src + milieu, nb);
+            fusionnerIdx(src + debut + i0, i1 - i0, src + milieu + (k0 - i0), (k1 - i1) - (k0 - i0), dst + debut + k0);
+        }
+        pthread_barrier_wait(&ctx->barriere);
+        AreteIdx *x = src;
+        src = dst;
+        dst = x;
+    }
+#undef BORNE
+
+    //Les arêtes égales sont consécutives ; une suite peut commencer dans la tranche précédente,
+    //on remonte alors jusqu'à sa tête (raccord entre tranches).
+    int tete = x0;
+    while (tete > 0 && src[tete - 1].cle == src[x0].cle)
+        tete--;
+    for (int p = x0; p < x1; p++)
+    {
+        if (src[p].cle != src[tete].cle)
+            tete = p;
+        ctx->premier[src[p].indice] = (tete == p) ? -1 : src[tete].indice;
+    }
+
+    if (th->id == 0)
+        ctx->trie = src;
+    return NULL;
+}
+
+
+/**
+ * @brief   Trie les arêtes en parallèle (tri fusion sur nbThreads threads)
+ *
+ * Les paires sont rangées dans l'ordre d'insertion de triAVL, le tableau lui est donc identique.
+ *
+ * @param   aretes   Tableau des arêtes
+ * @param   numEdges Nombre d'arêtes
+ * @param   paires   Arêtes équivalentes, ajoutées à la suite
+ */
+void triParallele(Arete *aretes, int numEdges, PairesD *paires)
+{
+    if (numEdges <= 0)
+        return;
+
+    ContexteParallele ctx;
+    ctx.aretes = aretes;
+    ctx.n = numEdges;
+    ctx.nbT = max(1, min(travailleurLot ? 1 : nbThreads, numEdges));   //Les travailleurs de --lot se partagent déjà les cœurs
+    ctx.t0 = allouer(numEdges * sizeof(AreteIdx));
+    ctx.t1 = allouer(numEdges * sizeof(AreteIdx));
+    ctx.premier = allouer(numEdges * sizeof(int));
+    pthread_barrier_init(&ctx.barriere, NULL, ctx.nbT);
+
+    pthread_t *threads = malloc(ctx.nbT * sizeof(pthread_t));
+    ThreadParallele *args = malloc(ctx.nbT * sizeof(ThreadParallele));
+    for (int t = 0; t < ctx.nbT; t++)
+    {
+        args[t].ctx = &ctx;
+        args[t].id = t;
+        pthread_create(&threads[t], NULL, travailParallele, &args[t]);
+    }
+    for (int t = 0; t < ctx.nbT; t++)
+        pthread_join(threads[t], NULL);
+
+    for (int i = 0; i < numEdges; i++)   //Même ordre que triAVL
+    {
+        if (ctx.premier[i] >= 0)
+            ajouterPaire(paires, aretes[ctx.premier[i]].faceA, aretes[i].faceA);
+    }
+
+    pthread_barrier_destroy(&ctx.barriere);
+    free(threads);
+    free(args);
+    free(ctx.t0);
+    free(ctx.t1);
+    free(ctx.premier);
+}
+
+
+// graphe dual CSR
+
+/**
+ * @brief   Construit le CSR dans des tableaux existants (mode --lot) : g->debut d'au moins
+ *          numF + 1 cases, g->voisins agrandi au besoin.
+ * @param   g           Graphe dual à remplir
+ * @param   paires      Arêtes duales trouvées par le moteur
+ * @param   numF        Nombre de faces
+ * @param   capVoisins  Capacité de g->voisins (0 : à créer), mise à jour
+ * @param   pos         Tableau de travail d'au moins numF entiers
+ */
+void remplirCSR(DualCSR *g, const PairesD *paires, int numF, int *capVoisins, int *pos)
+{
+    const int *p = paires->f;
+    g->numF = numF;
+    memset(g->debut, 0, sizeof(int) * (numF + 1));
+    g->graine = (paires->num > 0) ? p[2 * (paires->num - 1)] : 1;
+
+    int numAretes = 0;
+    for (int k = 0; k < paires->num; k++)   //Degrés, décalés d'une case
+    {
+        if (p[2 * k] == p[2 * k + 1])
+            continue;
+        g->debut[p[2 * k] + 1]++;
+        g->debut[p[2 * k + 1] + 1]++;
+        numAretes++;
+    }
+    for (int i = 0; i < numF; i++)    //Préfixe
+        g->debut[i + 1] += g->debut[i];
+
+    g->numAretes = numAretes;
+    if (2 * numAretes > *capVoisins || *capVoisins == 0)
+    {
+        size_t avant = sizeof(int) * *capVoisins;
+        *capVoisins = 2 * max(numAretes, 1);
+        g->voisins = reallouer(g->voisins, avant, sizeof(int) * *capVoisins);
+    }
+    memcpy(pos, g->debut, sizeof(int) * numF);
+    for (int k = paires->num - 1; k >= 0; k--)    //Dernière paire trouvée en premier, comme la graine
+    {
+        int f1 = p[2 * k], f2 = p[2 * k + 1];
+        if (f1 == f2)
+            continue;
+        g->voisins[pos[f1]++] = f2;
+        g->voisins[pos[f2]++] = f1;
+    }
+}
+
+
+/**
+ * @brief   Construit la représentation CSR (lignes compressées) du graphe dual.
+ *
+ * Fonctionne avec les paires de n'importe quel moteur. Les boucles (f1 == f2, faces
+ * dégénérées) sont ignorées. Les voisins de chaque face sont rangés de la dernière paire
+ * trouvée à la première.
+ *
+ * @param   paires  Arêtes duales
+ * @param   numF    Nombre de faces
+ * @return  Graphe dual, à libérer avec libererCSR
+ */
+DualCSR *construireCSR(const PairesD *paires, int numF)
+{
+    DualCSR *g = malloc(sizeof(DualCSR));
+    g->debut = allouer(sizeof(int) * (numF + 1));
+    g->voisins = NULL;
+    int capVoisins = 0;
+    int *pos = allouer(sizeof(int) * max(numF, 1));
+    remplirCSR(g, paires, numF, &capVoisins, pos);
+    free(pos);
+    return g;
+}
+
+
+/**
+ * @brief   Nombre de voisins d'une face dans le graphe dual
+ */
+static inline int degreCSR(const DualCSR *g, int f)
+{
+    return g->debut[f + 1] - g->debut[f];
+}
+
+
+/**
+ * @brief   Voisins d'une face : degreCSR(g, f) indices contigus
+ */
+static inline const int *voisinsCSR(const DualCSR *g, int f)
+{
+    return g->voisins + g->debut[f];
+}
+
+
+/**
+ * @brief   Libère un graphe dual construit par construireCSR.
+ */
+void libererCSR(DualCSR *g)
+{
+    if (g == NULL)
+        return;
+    free(g->debut);
+    free(g->voisins);
+    free(g);
+}
+
+
+// cache binaire
+
+#define CACHE_VERSION 3
+#define CACHE_ALIGNEMENT 64
+
+/**
+ * @brief   Somme de contrôle 64 bits, mot par mot (la taille doit être multiple de 8).
+ */
+uint64_t sommeControle(const void *data, size_t taille)
+{
+    const uint64_t *mots = data;
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < taille / 8; i++)
+    {
+        h ^= mots[i];
+        h *= 0x100000001b3ULL;
+        h ^= h >> 32;
+    }
+    return h;
+}
+
+
+static size_t aligner(size_t x)
+{
+    return (x + CACHE_ALIGNEMENT - 1) & ~(size_t)(CACHE_ALIGNEMENT - 1);
+}
+
+
+/**
+ * @brief   Place les sections du cache après l'en-tête à partir de numV, numF et numAretes.
+ */
+static void placerSections(EnteteCache *e)
+{
+    size_t numAretes = e->numAretes > 0 ? e->numAretes : 0;
+    e->offsetV = aligner(sizeof(EnteteCache));
+    e->offsetF = aligner(e->offsetV + sizeof(Vertex) * (size_t)e->numV);
+    e->offsetDebut = aligner(e->offsetF + sizeof(Face) * (size_t)e->numF);
+    e->offsetVoisins = aligner(e->offsetDebut + (e->numAretes >= 0 ? sizeof(int) * ((size_t)e->numF + 1) : 0));
+    e->tailleFichier = aligner(e->offsetVoisins + sizeof(int) * 2 * numAretes);
+}
+
+
+/**
+ * @brief   Somme de contrôle de tout le fichier, en-tête compris (champ somme mis à zéro).
+ */
+static uint64_t sommeCache(char *contenu, size_t taille)
+{
+    EnteteCache *e = (EnteteCache *)contenu;
+    uint64_t somme = e->somme;
+    e->somme = 0;
+    uint64_t h = sommeControle(contenu, taille);
+    e->somme = somme;
+    return h;
+}
+
+
+/**
+ * @brief   Écrit le cache binaire d'un maillage : en-tête, sommets, faces et, si g n'est pas
+ *          NULL, le graphe dual CSR. Chaque section est alignée sur 64 octets.
+ * @param   chemin   Nom du cache (par exemple bunny.obj.cache)
+ * @param   source   Nom du .obj d'origine
+ * @param   g        Graphe dual (peut être NULL)
+ * @param   moteur   Nom du moteur qui a produit g
+ * @return  1 en cas de succès, 0 en cas d'échec
+ */
+int ecrireCache(const char *chemin, const char *source, Vertex *v, int numV, Face *f, int numF, DualCSR *g,
+                const char *moteur)
+{
+    struct stat st;
+    if (stat(source, &st) < 0)
+        return 0;
+
+    int numAretes = g ? g->numAretes : 0;
+
+    EnteteCache e;
+    memset(&e, 0, sizeof(e));
+    memcpy(e.magie, "SDACACHE", 8);
+    e.version = CACHE_VERSION;
+    e.tailleEntete = sizeof(EnteteCache);
+    e.tailleSource = st.st_size;
+    e.dateSource = st.st_mtime;
+    e.numV = numV;
+    e.numF = numF;
+    e.numAretes = g ? numAretes : -1;
+    e.graine = g ? g->graine : 0;
+    snprintf(e.moteur, sizeof(e.moteur), "%s", moteur);
+    placerSections(&e);
+
+    char *contenu = calloc(1, e.tailleFichier);
+    if (contenu == NULL)
+        return 0;
+    memcpy(contenu + e.offsetV, v, sizeof(Vertex) * (size_t)numV);
+    memcpy(contenu + e.offsetF, f, sizeof(Face) * (size_t)numF);
+    if (g != NULL)
+    {
+        memcpy(contenu + e.offsetDebut, g->debut, sizeof(int) * ((size_t)numF + 1));
+        memcpy(contenu + e.offsetVoisins, g->voisins, sizeof(int) * 2 * (size_t)numAretes);
+    }
+    memcpy(contenu, &e, sizeof(e));
+    ((EnteteCache *)contenu)->somme = sommeCache(contenu, e.tailleFichier);
+
+    //Fichier temporaire renommé à la fin : un lecteur concurrent ne voit jamais un cache à moitié écrit
+    char *temporaire = malloc(strlen(chemin) + 8);
+    if (temporaire == NULL)
+    {
+        free(contenu);
+        return 0;
+    }
+    sprintf(temporaire, "%s.XXXXXX", chemin);
+    int fd = mkstemp(temporaire);
+    FILE *file = fd >= 0 ? fdopen(fd, "wb") : NULL;
+    if (file == NULL)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+            remove(temporaire);
+        }
+        free(temporaire);
+        free(contenu);
+        return 0;
+    }
+    size_t ecrit = fwrite(contenu, 1, e.tailleFichier, file);
+    free(contenu);
+    int ok = fclose(file) == 0 && ecrit == e.tailleFichier;
+    //mkstemp crée le fichier en 0600 : on reprend les droits habituels
+    mode_t masque = umask(0);
+    umask(masque);
+    if (ok)
+        ok = chmod(temporaire, 0666 & ~masque) == 0 && rename(temporaire, chemin) == 0;
+    if (!ok)
+        remove(temporaire);
+    free(temporaire);
+    return ok;
+}
+
+
+/**
+ * @brief   Vérifie que l'en-tête décrit bien un fichier de la taille donnée : chaque section
+ *          doit être à sa place, dans le fichier, et de la taille annoncée par les compteurs.
+ */
+static int enteteValide(const EnteteCache *e, size_t taille)
+{
+    if (e->numV < 0 || e->numF < 0 || e->numAretes < -1 || e->tailleFichier != taille)
+        return 0;
+    if (e->numAretes >= 0 && e->numF > 0 && (e->graine < 0 || e->graine >= e->numF))
+        return 0;
+    EnteteCache attendu = *e;
+    placerSections(&attendu);
+    return e->offsetV == attendu.offsetV && e->offsetF == attendu.offsetF && e->offsetDebut == attendu.offsetDebut &&
+           e->offsetVoisins == attendu.offsetVoisins && e->tailleFichier == attendu.tailleFichier;
+}
+
+
+/**
+ * @brief   Projette un cache binaire en mémoire : les tableaux et le graphe dual CSR pointent
+ *          directement dans la projection, sans copie ni analyse.
+ *
+ * Le cache est refusé s'il est périmé (le .obj a changé), d'une autre version ou corrompu.
+ * Le graphe dual n'est gardé que s'il vient du même moteur.
+ *
+ * @param   chemin  Nom du cache
+ * @param   source  Nom du .obj d'origine
+ * @param   moteur  Moteur demandé
+ * @param   c       Cache chargé
+ * @return  1 si le cache est utilisable, 0 sinon
+ */
+int chargerCache(const char *chemin, const char *source, const char *moteur, Cache *c)
+{
+    struct stat src, st;
+    if (stat(source, &src) < 0)
+        return 0;
+
+    int fd = open(chemin, O_RDONLY);
+    if (fd < 0)
+        return 0;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(EnteteCache))
+    {
+        close(fd);
+        return 0;
+    }
+    //Copie sur écriture : les étapes suivantes peuvent modifier les tableaux sans toucher au fichier
+    void *data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return 0;
+
+    EnteteCache *e = data;
+    //L'en-tête est vérifié avant de s'en servir pour lire le reste du fichier
+    if (memcmp(e->magie, "SDACACHE", 8) != 0 || e->version != CACHE_VERSION || e->tailleEntete != sizeof(EnteteCache) ||
+        !enteteValide(e, st.st_size) || e->tailleSource != (uint64_t)src.st_size ||
+        e->dateSource != (int64_t)src.st_mtime || sommeCache(data, st.st_size) != e->somme)
+    {
+        munmap(data, st.st_size);
+        return 0;
+    }
+
+    c->data = data;
+    c->taille = st.st_size;
+    c->v = (Vertex *)((char *)data + e->offsetV);
+    c->f = (Face *)((char *)data + e->offsetF);
+    c->numV = e->numV;
+    c->numF = e->numF;
+    c->dual.debut = NULL;
+    if (e->numAretes >= 0 && strncmp(e->moteur, moteur, sizeof(e->moteur)) == 0)
+    {
+        c->dual.numF = e->numF;
+        c->dual.numAretes = e->numAretes;
+        c->dual.debut = (int *)((char *)data + e->offsetDebut);
+        c->dual.voisins = (int *)((char *)data + e->offsetVoisins);
+        c->dual.graine = e->graine;
+    }
+    return 1;
+}
+
+
+// hors mémoire
+
+long long limiteMemoire = 0;    //Option --mem-limit (octets), 0 : tout en mémoire
+
+#define HM_MIN_TAMPON (64 * 1024)       //Plus petit tampon de lecture d'un run pendant la fusion
+#define HM_TAMPON_FICHIER (16 * 1024)   //Tampon stdio de chaque fichier lu ou écrit enregistrement par enregistrement
+#define HM_NUM_FICHIERS 6               //Entrée, sommets, faces, paires, voisins, débuts
+#define HM_PAGE 4096                    //Page de l'adjacence (entiers de 4 et 8 octets)
+#define HM_PAGE_SOMMETS 3072            //Multiple de sizeof(Vertex) : un sommet ne chevauche jamais deux pages
+
+static long long hmOctets, hmPic;       //Tampons du mode hors mémoire : octets alloués et pic
+
+
+/**
+ * @brief   Alloue un tampon compté dans la limite de --mem-limit.
+ */
+static void *allouerHM(size_t taille)
+{
+    hmOctets += taille;
+    hmPic = max(hmPic, hmOctets);
+    return malloc(max(taille, (size_t)1));
+}
+
+
+static void libererHM(void *p, size_t taille)
+{
+    if (p == NULL)
+        return;
+    hmOctets -= taille;
+    free(p);
+}
+
+
+typedef struct lecteurRun
+{
+    FILE *f;
+    AreteCle *buf;
+    size_t n, pos, cap;
+} LecteurRun;
+
+typedef struct fusionHM
+{
+    FILE *paires;           //Paires (f1, f2) du graphe dual, dans l'ordre de triRadix
+    long long numPaires;
+    int graine;             //f1 de la dernière paire trouvée, comme la graine de remplirCSR
+    int aPrecedent;
+    AreteCle precedent;
+    int premiere;           //Face de la première arête de la suite courante (appariement en étoile)
+} FusionHM;
+
+/**
+ * @brief   Tri externe d'enregistrements AreteCle : lots triés en mémoire écrits en runs,
+ *          puis fusionnés. Toute la mémoire du trieur (lots et tableau des runs) tient dans
+ *          "memoire" ; les lots sont rendus pendant les fusions, qui reprennent la même mémoire.
+ */
+typedef struct trieurHM
+{
+    size_t memoire;
+    int bits;               //Bits significatifs des clés (tri radix)
+    AreteCle *lot, *tmp;
+    int n, lotMax;
+    FILE **runs;
+    int numRuns, capRuns;
+    int depuis;             //Premier run écrit depuis la dernière réduction
+    int eventail;           //Runs fusionnés à la fois
+    int ok;
+} TrieurHM;
+
+/**
+ * @brief   Lecture aléatoire d'un fichier temporaire par petites pages, gardées dans un cache
+ *          à correspondance directe. Les accès croissants (frontière triée) lisent chaque page
+ *          au plus une fois par niveau.
+ */
+typedef struct lecteurBloc
+{
+    int fd;
+    size_t taillePage;      //Multiple de la taille des éléments lus
+    char *pages;
+    long long *numeros;     //Page chargée dans chaque case, -1 si vide
+    int numCases;
+    long long lectures;     //Pages lues sur le disque
+    int erreur;
+} LecteurBloc;
+
+
+/**
+ * @brief   Lit l'enregistrement suivant d'un run (tampon rechargé au besoin).
+ * @return  1 si un enregistrement a été lu, 0 à la fin du run
+ */
+static int lireRun(LecteurRun *r, AreteCle *x)
+{
+    if (r->pos == r->n)
+    {
+        r->n = fread(r->buf, sizeof(AreteCle), r->cap, r->f);
+        r->pos = 0;
+        if (r->n == 0)
+            return 0;
+    }
+    *x = r->buf[r->pos++];
+    return 1;
+}
+
+
+/**
+ * @brief   Fichier temporaire sans tampon stdio : les runs sont lus et écrits par gros blocs
+ *          déjà comptés dans la limite.
+ */
+static FILE *nouveauRun(void)
+{
+    FILE *run = tmpfile();
+    if (run != NULL)
+        setvbuf(run, NULL, _IONBF, 0);
+    return run;
+}
+
+
+/**
+ * @brief   Trie un lot d'arêtes en mémoire (tri radix) et l'écrit dans un nouveau run.
+ * @return  Le run, rembobiné, NULL en cas d'échec
+ */
+static FILE *ecrireRun(AreteCle *lot, AreteCle *tmp, int n, int bits)
+{
+    FILE *run = nouveauRun();
+    if (run == NULL)
+        return NULL;
+    AreteCle *trie = trierRadixCles(lot, tmp, n, bits);
+    if (fwrite(trie, sizeof(AreteCle), n, run) != (size_t)n)
+    {
+        fclose(run);
+        return NULL;
+    }
+    rewind(run);
+    return run;
+}
+
+
+/**
+ * @brief   Fusionne k runs triés avec un tas de leurs têtes. À clé égale, le run le plus ancien
+ *          passe d'abord : la fusion reste stable, comme le tri de triRadix.
+ *
+ * Si sortie n'est pas NULL, le résultat est un nouveau run ; sinon les arêtes équivalentes
+ * (consécutives) sont écrites comme paires duales dans app.
+ *
+ * @param   runs    Runs à fusionner (fermés après)
+ * @param   k       Nombre de runs
+ * @param   memoire Mémoire de la fusion (tampons de lecture, d'écriture et tas)
+ * @param   sortie  Run de sortie ou NULL
+ * @param   app     Appariement final (si sortie vaut NULL)
+ * @return  1 en cas de succès, 0 en cas d'échec
+ */
+static int fusionnerRuns(FILE **runs, int k, size_t memoire, FILE *sortie, FusionHM *app)
+{
+    size_t fixe = k * (sizeof(LecteurRun) + sizeof(AreteCle) + sizeof(int));
+    LecteurRun *lecteurs = allouerHM(k * sizeof(LecteurRun));
+    AreteCle *tetes = allouerHM(k * sizeof(AreteCle));
+    int *tas = allouerHM(k * sizeof(int));
+    size_t cap = max((memoire - min(fixe, memoire)) / (k + 1) / sizeof(AreteCle), (size_t)1);
+    AreteCle *sortieBuf = allouerHM(cap * sizeof(AreteCle));
+    size_t sortieN = 0;
+    int ok = 1;
+
+    int taille = 0;
+    for (int i = 0; i < k; i++)
+    {
+        lecteurs[i].f = runs[i];
+        lecteurs[i].cap = cap;
+        lecteurs[i].buf = allouerHM(cap * sizeof(AreteCle));
+        lecteurs[i].n = lecteurs[i].pos = 0;
+        if (lireRun(&lecteurs[i], &tetes[i]))
+            tas[taille++] = i;
+    }
+
+#define AVANT(x, y) (tetes[x].cle < tetes[y].cle || (tetes[x].cle == tetes[y].cle && (x) < (y)))
+    for (int i = taille / 2 - 1; i >= 0; i--)    //Construit le tas (tamisage vers le bas)
+    {
+        int p = i;
+        while (1)
+        {
+            int m = p, g = 2 * p + 1, d = 2 * p + 2;
+            if (g < taille && AVANT(tas[g], tas[m]))
+                m = g;
+            if (d < taille && AVANT(tas[d], tas[m]))
+                m = d;
+            if (m == p)
+                break;
+            int t = tas[p];
+            tas[p] = tas[m];
+            tas[m] = t;
+            p = m;
+        }
+    }
+
+    while (taille > 0)
+    {
+        int r = tas[0];
+        AreteCle x = tetes[r];
+
+        if (sortie != NULL)
+        {
+            sortieBuf[sortieN++] = x;
+            if (sortieN == cap)
+            {
+                ok &= fwrite(sortieBuf, sizeof(AreteCle), sortieN, sortie) == sortieN;
+                sortieN = 0;
+            }
+        }
+        else
+        {
+            if (app->aPrecedent && app->precedent.cle == x.cle)   //Les côtés identiques sont consécutifs
+            {
+                app->graine = app->premiere;
+                if (app->premiere != x.faceA)    //Les boucles sont ignorées, comme dans construireCSR
+                {
+                    int paire[2] = {app->premiere, x.faceA};    //Première face de la suite, comme triRadix
+                    ok &= fwrite(paire, sizeof(int), 2, app->paires) == 2;
+                    app->numPaires++;
+                }
+            }
+            else
+                app->premiere = x.faceA;
+            app->precedent = x;
+            app->aPrecedent = 1;
+        }
+
+        if (!lireRun(&lecteurs[r], &tetes[r]))
+            tas[0] = tas[--taille];
+        int p = 0;
+        while (1)
+        {
+            int m = p, g = 2 * p + 1, d = 2 * p + 2;
+            if (g < taille && AVANT(tas[g], tas[m]))
+                m = g;
+            if (d < taille && AVANT(tas[d], tas[m]))
+                m = d;
+            if (m == p)
+                break;
+            int t = tas[p];
+            tas[p] = tas[m];
+            tas[m] = t;
+            p = m;
+        }
+    }
+#undef AVANT
+
+    if (sortie != NULL && sortieN > 0)
+        ok &= fwrite(sortieBuf, sizeof(AreteCle), sortieN, sortie) == sortieN;
+
+    for (int i = 0; i < k; i++)
+    {
+        libererHM(lecteurs[i].buf, cap * sizeof(AreteCle));
+        fclose(runs[i]);
+    }
+    libererHM(lecteurs, k * sizeof(LecteurRun));
+    libererHM(tetes, k * sizeof(AreteCle));
+    libererHM(tas, k * sizeof(int));
+    libererHM(sortieBuf, cap * sizeof(AreteCle));
+    return ok;
+}
+
+
+static void allouerLots(TrieurHM *t)
+{
+    t->lot = allouerHM(t->lotMax * sizeof(AreteCle));
+    t->tmp = allouerHM(t->lotMax * sizeof(AreteCle));
+}
+
+
+static void libererLots(TrieurHM *t)
+{
+    libererHM(t->lot, t->lotMax * sizeof(AreteCle));
+    libererHM(t->tmp, t->lotMax * sizeof(AreteCle));
+    t->lot = t->tmp = NULL;
+}
+
+
+/**
+ * @brief   Prépare un tri externe dans "memoire" octets : un soixante-quatrième pour le tableau
+ *          des runs, le reste pour les deux lots (données et tampon du tri radix).
+ */
+static void ouvrirTrieur(TrieurHM *t, size_t memoire, int bits)
+{
+    memset(t, 0, sizeof(TrieurHM));
+    t->memoire = memoire;
+    t->bits = bits;
+    t->ok = 1;
+    t->eventail = (int)max(2LL, (long long)(memoire / HM_MIN_TAMPON) - 1);
+    t->capRuns = (int)max((size_t)(2 * t->eventail + 2), memoire / 64 / sizeof(FILE *));
+    t->runs = allouerHM(t->capRuns * sizeof(FILE *));
+    t->lotMax = (int)min((memoire - t->capRuns * sizeof(FILE *)) / (2 * sizeof(AreteCle)), (size_t)2000000000);
+    t->lotMax = max(t->lotMax, 1);
+    allouerLots(t);
+}
+
+
+/**
+ * @brief   Fusionne runs[depuis...] par groupes de t->eventail (lots déjà rendus).
+ */
+static void reduireRuns(TrieurHM *t, int depuis)
+{
+    int nouveaux = depuis;
+    for (int i = depuis; t->ok && i < t->numRuns; i += t->eventail)
+    {
+        int k = min(t->eventail, t->numRuns - i);
+        FILE *sortie = nouveauRun();
+        t->ok &= sortie != NULL && fusionnerRuns(t->runs + i, k, t->memoire - t->capRuns * sizeof(FILE *), sortie, NULL);
+        if (sortie != NULL)
+            rewind(sortie);
+        t->runs[nouveaux++] = sortie;
+    }
+    t->numRuns = nouveaux;
+}
+
+
+/**
+ * @brief   Écrit le lot courant en run. Quand le tableau des runs est plein, les runs écrits
+ *          depuis la dernière réduction sont fusionnés (tous, s'il reste trop peu de place).
+ */
+static void viderLot(TrieurHM *t)
+{
+    if (t->n == 0)
+        return;
+    t->runs[t->numRuns] = ecrireRun(t->lot, t->tmp, t->n, t->bits);
+    t->ok &= t->runs[t->numRuns++] != NULL;
+    t->n = 0;
+    if (t->ok && t->numRuns == t->capRuns)
+    {
+        libererLots(t);
+        reduireRuns(t, t->depuis);
+        if (t->numRuns > t->capRuns / 2)
+            reduireRuns(t, 0);
+        t->depuis = t->numRuns;
+        allouerLots(t);
+    }
+}
+
+
+static inline void ajouterTrieur(TrieurHM *t, uint64_t cle, int face)
+{
+    t->lot[t->n].cle = cle;
+    t->lot[t->n].faceA = face;
+    if (++t->n == t->lotMax)
+        viderLot(t);
+}
+
+
+/**
+ * @brief   Termine le tri : si app n'est pas NULL, la dernière fusion apparie les arêtes,
+ *          sinon elle produit un seul run trié.
+ * @return  Le run trié et rembobiné (vide s'il n'y avait rien), NULL avec app ou en cas d'échec
+ */
+static FILE *terminerTrieur(TrieurHM *t, FusionHM *app)
+{
+    viderLot(t);
+    libererLots(t);
+    while (t->ok && t->numRuns > t->eventail)
+        reduireRuns(t, 0);
+
+    FILE *resultat = NULL;
+    size_t memoire = t->memoire - t->capRuns * sizeof(FILE *);
+    if (t->ok && app != NULL)
+        t->ok &= fusionnerRuns(t->runs, t->numRuns, memoire, NULL, app);
+    else if (t->ok && t->numRuns == 1)
+        resultat = t->runs[0];
+    else if (t->ok)
+    {
+        resultat = nouveauRun();
+        t->ok &= resultat != NULL && fusionnerRuns(t->runs, t->numRuns, memoire, resultat, NULL);
+        if (resultat != NULL)
+            rewind(resultat);
+    }
+    else
+    {
+        for (int i = 0; i < t->numRuns; i++)
+            if (t->runs[i] != NULL)
+                fclose(t->runs[i]);
+    }
+    libererHM(t->runs, t->capRuns * sizeof(FILE *));
+    t->runs = NULL;
+    if (!t->ok && resultat != NULL)
+    {
+        fclose(resultat);
+        resultat = NULL;
+    }
+    return resultat;
+}
+
+
+static void ouvrirLecteurBloc(LecteurBloc *l, FILE *f, size_t memoire, size_t taillePage)
+{
+    fflush(f);
+    l->fd = fileno(f);
+    l->taillePage = taillePage;
+    l->numCases = (int)max((size_t)1, memoire / (taillePage + sizeof(long long)));
+    l->pages = allouerHM((size_t)l->numCases * taillePage);
+    l->numeros = allouerHM(l->numCases * sizeof(long long));
+    for (int i = 0; i < l->numCases; i++)
+        l->numeros[i] = -1;
+    l->lectures = 0;
+    l->erreur = 0;
+}
+
+
+static void fermerLecteurBloc(LecteurBloc *l)
+{
+    libererHM(l->pages, (size_t)l->numCases * l->taillePage);
+    libererHM(l->numeros, l->numCases * sizeof(long long));
+}
+
+
+/**
+ * @brief   Adresse de l'élément qui commence à l'octet "position" du fichier.
+ */
+static inline const void *lireBloc(LecteurBloc *l, uint64_t position)
+{
+    long long page = position / l->taillePage;
+    int c = (int)(page % l->numCases);
+    char *p = l->pages + (size_t)c * l->taillePage;
+    if (l->numeros[c] != page)
+    {
+        if (pread(l->fd, p, l->taillePage, (off_t)page * l->taillePage) < 0)    //La dernière page peut être courte
+            l->erreur = 1;
+        l->numeros[c] = page;
+        l->lectures++;
+    }
+    return p + position % l->taillePage;
+}
+
+
+/**
+ * @brief   Construit la liste d'adjacence triée sur disque à partir des paires : chaque paire
+ *          donne deux enregistrements (face, voisin), triés par face, puis écrits en deux
+ *          fichiers : les voisins (int) et les débuts de chaque face (numF + 1 entiers 64 bits).
+ * @return  1 en cas de succès, 0 en cas d'échec
+ */
+static int construireAdjacenceHM(FILE *paires, int numF, size_t memoire, FILE *voisins, FILE *debuts)
+{
+    TrieurHM t;
+    ouvrirTrieur(&t, memoire, 32);
+    rewind(paires);
+    int p[2];
+    while (t.ok && fread(p, sizeof(int), 2, paires) == 2)
+    {
+        ajouterTrieur(&t, (uint32_t)p[0], p[1]);
+        ajouterTrieur(&t, (uint32_t)p[1], p[0]);
+    }
+    FILE *adjacence = terminerTrieur(&t, NULL);
+    if (adjacence == NULL)
+        return 0;
+
+    size_t cap = max(memoire / sizeof(AreteCle), (size_t)1);
+    AreteCle *buf = allouerHM(cap * sizeof(AreteCle));
+    int ok = 1;
+    long long position = 0;
+    int face = 0;
+    size_t lus;
+    while (ok && (lus = fread(buf, sizeof(AreteCle), cap, adjacence)) > 0)
+    {
+        for (size_t i = 0; i < lus; i++)
+        {
+            for (; face <= (int)buf[i].cle; face++)
+                ok &= fwrite(&position, sizeof(long long), 1, debuts) == 1;
+            ok &= fwrite(&buf[i].faceA, sizeof(int), 1, voisins) == 1;
+            position++;
+        }
+    }
+    for (; face <= numF; face++)
+        ok &= fwrite(&position, sizeof(long long), 1, debuts) == 1;
+    libererHM(buf, cap * sizeof(AreteCle));
+    fclose(adjacence);
+    return ok && fflush(voisins) == 0 && fflush(debuts) == 0;
+}
+
+
+/**
+ * @brief   Parcours en largeur externe, niveau par niveau : la frontière est un run trié
+ *          sur disque, les voisins de ses faces sont lus dans l'adjacence triée par accès
+ *          croissants ; les faces découvertes forment la frontière suivante, triée à son tour.
+ *          Seul le tableau des distances est en mémoire.
+ * @param   memoire Mémoire de travail (hors distances) : un quart pour relire la frontière,
+ *                  un quart pour trier la suivante, un quart par fichier d'adjacence
+ * @return  Distance maximale, -1 en cas d'échec
+ */
+static int bfsExterne(FILE *voisins, FILE *debuts, int *distance, int source, size_t memoire, int *numNiveaux,
+                      long long *pagesLues)
+{
+    LecteurBloc lv, ld;
+    ouvrirLecteurBloc(&lv, voisins, memoire / 4, HM_PAGE);
+    ouvrirLecteurBloc(&ld, debuts, memoire / 4, HM_PAGE);
+    size_t cap = max(memoire / 4 / sizeof(AreteCle), (size_t)1);
+    AreteCle *buf = allouerHM(cap * sizeof(AreteCle));
+
+    FILE *frontiere = nouveauRun();
+    AreteCle graine = {(uint64_t)source, 0};
+    int ok = frontiere != NULL && fwrite(&graine, sizeof(AreteCle), 1, frontiere) == 1;
+    if (frontiere != NULL)
+        rewind(frontiere);
+    distance[source] = 0;
+
+    int niveau = 0;
+    while (ok)
+    {
+        TrieurHM suivante;
+        ouvrirTrieur(&suivante, memoire / 4, 32);
+        size_t lus;
+        while ((lus = fread(buf, sizeof(AreteCle), cap, frontiere)) > 0)
+        {
+            for (size_t i = 0; i < lus; i++)
+            {
+                int f = (int)buf[i].cle;
+                long long a = *(const long long *)lireBloc(&ld, (uint64_t)f * sizeof(long long));
+                long long b = *(const long long *)lireBloc(&ld, (uint64_t)(f + 1) * sizeof(long long));
+                for (long long p = a; p < b; p++)
+                {
+                    int y = *(const int *)lireBloc(&lv, (uint64_t)p * sizeof(int));
+                    if (distance[y] == -1)
+                    {
+                        distance[y] = niveau + 1;
+                        ajouterTrieur(&suivante, (uint32_t)y, 0);
+                    }
+                }
+            }
+        }
+        fclose(frontiere);
+        int vide = suivante.n == 0 && suivante.numRuns == 0;
+        frontiere = terminerTrieur(&suivante, NULL);
+        ok = suivante.ok && !lv.erreur && !ld.erreur;
+        if (vide || !ok)
+            break;
+        niveau++;
+    }
+    if (frontiere != NULL)
+        fclose(frontiere);
+
+    *numNiveaux = niveau + 1;
+    *pagesLues = lv.lectures + ld.lectures;
+    libererHM(buf, cap * sizeof(AreteCle));
+    fermerLecteurBloc(&lv);
+    fermerLecteurBloc(&ld);
+    return ok ? niveau : -1;
+}
+
+
+/**
+ * @brief   Construit le graphe dual, les distances et le .obj de sortie sans jamais garder tout
+ *          le maillage en mémoire.
+ *
+ * 1. Le .obj est lu ligne par ligne : les sommets et les faces vont dans des fichiers
+ *    temporaires, les arêtes sont triées par lots qui tiennent dans la limite (runs).
+ * 2. Les runs sont fusionnés (en plusieurs passes s'il y en a trop) ; les arêtes consécutives
+ *    égales donnent les paires duales, dans l'ordre de triRadix.
+ * 3. Les paires sont retriées par face en une liste d'adjacence sur disque.
+ * 4. Les distances viennent d'un parcours en largeur externe (bfsExterne) : une lecture de
+ *    l'adjacence par niveau, limitée aux faces de la frontière.
+ * 5. La sortie est écrite au fil de l'eau : centroïdes calculés face par face (sommets lus par
+ *    pages dans le fichier temporaire), puis paires.
+ *
+ * Tous les tampons sont comptés dans la limite : les tampons stdio des fichiers lus ou écrits
+ * enregistrement par enregistrement, puis, à chaque étape, le reste de la limite (moins le
+ * tableau des distances à partir de l'étape 4) partagé entre les tampons de l'étape.
+ *
+ * Le résultat est celui de -m radix : mêmes lignes v, même ensemble de lignes l.
+ *
+ * @param   filename    Nom du .obj d'entrée
+ * @param   fileDst     Nom du .obj de sortie
+ * @param   limite      Mémoire autorisée pour les tampons, en octets
+ * @return  1 en cas de succès, 0 en cas d'échec
+ */
+int traiterHorsMemoire(const char *filename, const char *fileDst, long long limite)
+{
+    double debut = tempsMur();
+    hmOctets = hmPic = 0;
+    char *tamponsFichiers = allouerHM(HM_NUM_FICHIERS * HM_TAMPON_FICHIER);
+    size_t reste = limite - HM_NUM_FICHIERS * HM_TAMPON_FICHIER;    //Mémoire de chaque étape
+
+    FILE *file = fopen(filename, "r");
+    if (!file)
+    {
+        printf("Impossible d'ouvrir le fichier .obj\n");
+        libererHM(tamponsFichiers, HM_NUM_FICHIERS * HM_TAMPON_FICHIER);
+        return 0;
+    }
+    FILE *sommets = tmpfile();
+    FILE *faces = tmpfile();
+    FILE *voisins = tmpfile();
+    FILE *debuts = tmpfile();
+    FusionHM app;
+    memset(&app, 0, sizeof(app));
+    app.graine = 1;
+    app.paires = tmpfile();
+    if (sommets == NULL || faces == NULL || voisins == NULL || debuts == NULL || app.paires == NULL)
+    {
+        printf("Impossible de créer les fichiers temporaires\n");
+        fclose(file);
+        libererHM(tamponsFichiers, HM_NUM_FICHIERS * HM_TAMPON_FICHIER);
+        return 0;
+    }
+    FILE *fichiers[HM_NUM_FICHIERS] = {file, sommets, faces, app.paires, voisins, debuts};
+    for (int i = 0; i < HM_NUM_FICHIERS; i++)
+        setvbuf(fichiers[i], tamponsFichiers + i * HM_TAMPON_FICHIER, _IOFBF, HM_TAMPON_FICHIER);
+
+    //Étapes 1 et 2 : lots d'arêtes triés en runs, fusion et appariement
+    TrieurHM aretes;
+    ouvrirTrieur(&aretes, reste, 64);
+    int numV = 0, numF = 0, maxIndice = 0;
+    char line[4096];
+
+    while (aretes.ok && fgets(line, sizeof(line), file))
+    {
+        const char *finLigne = line + strcspn(line, "\n");
+        char type = typeLigne(line, finLigne);
+        if (type == 'v')
+        {
+            Vertex s;
+            lireSommet(line + 1, finLigne, &s);
+            aretes.ok &= fwrite(&s, sizeof(Vertex), 1, sommets) == 1;
+            numV++;
+        }
+        else if (type == 'f')
+        {
+            Face nf;
+            if (!lireFace(line + 1, finLigne, numV, &nf))
+                continue;
+            maxIndice = max(maxIndice, max(max(nf.v1, nf.v2), nf.v3));
+            aretes.ok &= fwrite(&nf, sizeof(Face), 1, faces) == 1;
+
+            Arete tri[3];    //Mêmes arêtes, dans le même ordre, que generalise
+            tri[0].num1 = min(nf.v1, nf.v2);
+            tri[0].num2 = max(nf.v1, nf.v2);
+            tri[1].num1 = min(nf.v2, nf.v3);
+            tri[1].num2 = max(nf.v2, nf.v3);
+            tri[2].num1 = min(nf.v1, nf.v3);
+            tri[2].num2 = max(nf.v1, nf.v3);
+            for (int k = 0; k < 3; k++)
+                ajouterTrieur(&aretes, cleArete(tri[k]), numF);
+            numF++;
+        }
+    }
+    fclose(file);
+    int numRuns = aretes.numRuns + (aretes.n > 0);
+    terminerTrieur(&aretes, &app);
+    int ok = aretes.ok;
+    printf("Hors mémoire : %d sommets, %d faces, %d run%s\n", numV, numF, numRuns, numRuns > 1 ? "s" : "");
+    if (maxIndice > numV)
+    {
+        printf("Indice de sommet %d au-delà des %d sommets\n", maxIndice, numV);
+        ok = 0;
+    }
+
+    //Étape 3 : adjacence triée par face
+    if (ok)
+        ok = construireAdjacenceHM(app.paires, numF, reste, voisins, debuts);
+
+    //Étape 4 : distances, seul tableau de taille numF gardé en mémoire
+    size_t tailleDistances = (size_t)numF * sizeof(int);
+    if (ok && tailleDistances > reste / 2)
+    {
+        printf("Limite mémoire trop petite : les distances demandent %zu octets\n", tailleDistances);
+        ok = 0;
+    }
+    reste -= min(tailleDistances, reste);
+    int *distance = NULL;
+    int maxDistance = 0;
+    if (ok && numF > 0)
+    {
+        distance = allouerHM(tailleDistances);
+        for (int i = 0; i < numF; i++)
+            distance[i] = -1;
+        int numNiveaux;
+        long long pagesLues;
+        maxDistance = bfsExterne(voisins, debuts, distance, max(app.graine - 1, 0), reste, &numNiveaux, &pagesLues);
+        ok = maxDistance >= 0;
+        printf("Distances : %d niveaux sur %lld paires, %lld pages d'adjacence lues (%lld Ko)\n", numNiveaux,
+               app.numPaires, pagesLues, pagesLues * HM_PAGE / 1024);
+    }
+
+    //Étape 5 : sortie au fil de l'eau ; un quart du reste pour chaque tampon
+    Tampon *sortie = ok ? ouvrirTamponTaille(fileDst, 0, reste / 4) : NULL;
+    if (ok && sortie == NULL)
+    {
+        fprintf(stderr, "write\n");
+        ok = 0;
+    }
+    if (ok)
+    {
+        hmOctets += reste / 4;    //Tampon de sortie
+        hmPic = max(hmPic, hmOctets);
+        printf("%d\n", maxDistance);
+        float parametre = 1.0 / maxDistance;
+        printf("%f\n", parametre);
+
+        LecteurBloc ls;
+        ouvrirLecteurBloc(&ls, sommets, reste / 4, HM_PAGE_SOMMETS);
+        size_t capFaces = max(reste / 4 / sizeof(Face), (size_t)1);
+        Face *bloc = allouerHM(capFaces * sizeof(Face));
+        rewind(faces);
+        int i = 0;
+        size_t lus;
+        while (ok && (lus = fread(bloc, sizeof(Face), capFaces, faces)) > 0)
+        {
+            for (size_t k = 0; k < lus; k++, i++)
+            {
+                Vertex s1 = *(const Vertex *)lireBloc(&ls, (uint64_t)(bloc[k].v1 - 1) * sizeof(Vertex));
+                Vertex s2 = *(const Vertex *)lireBloc(&ls, (uint64_t)(bloc[k].v2 - 1) * sizeof(Vertex));
+                Vertex s3 = *(const Vertex *)lireBloc(&ls, (uint64_t)(bloc[k].v3 - 1) * sizeof(Vertex));
+                Centoide c;    //Même calcul que calculateCentroids
+                c.centre.a = (s1.a + s2.a + s3.a) / 3.0;
+                c.centre.b = (s1.b + s2.b + s3.b) / 3.0;
+                c.centre.c = (s1.c + s2.c + s3.c) / 3.0;
+                tamponTexte(sortie, "v ");
+                tamponFloat(sortie, c.centre.a);
+                tamponTexte(sortie, " ");
+                tamponFloat(sortie, c.centre.b);
+                tamponTexte(sortie, " ");
+                tamponFloat(sortie, c.centre.c);
+                tamponTexte(sortie, " ");
+                tamponFloat(sortie, (1.0 - distance[i]) * parametre);
+                tamponTexte(sortie, " ");
+                tamponFloat(sortie, distance[i] * parametre);
+                tamponTexte(sortie, " 0.000000\n");
+            }
+        }
+        ok &= !ls.erreur;
+        libererHM(bloc, capFaces * sizeof(Face));
+        fermerLecteurBloc(&ls);
+
+        size_t capPaires = max(reste / 4 / (2 * sizeof(int)), (size_t)1);
+        int *paires = allouerHM(capPaires * 2 * sizeof(int));
+        rewind(app.paires);
+        while (ok && (lus = fread(paires, 2 * sizeof(int), capPaires, app.paires)) > 0)
+        {
+            for (size_t k = 0; k < lus; k++)
+            {
+                tamponTexte(sortie, "l ");
+                tamponInt(sortie, min(paires[2 * k], paires[2 * k + 1]) + 1);
+                tamponTexte(sortie, " ");
+                tamponInt(sortie, max(paires[2 * k], paires[2 * k + 1]) + 1);
+                tamponTexte(sortie, "\n");
+            }
+        }
+        libererHM(paires, capPaires * 2 * sizeof(int));
+        ok &= fermerTampon(sortie);
+        hmOctets -= reste / 4;
+    }
+
+    libererHM(distance, tailleDistances);
+    fclose(sommets);
+    fclose(faces);
+    fclose(voisins);
+    fclose(debuts);
+    fclose(app.paires);
+    libererHM(tamponsFichiers, HM_NUM_FICHIERS * HM_TAMPON_FICHIER);
+
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    printf("Hors mémoire : %f s, limite %lld octets, tampons au plus %lld octets, pic RSS %ld Ko\n",
+           tempsMur() - debut, limite, hmPic, ru.ru_maxrss);
+    return ok;
+}
+
+// coloration bfs
+/**
+ * @brief   Crée un tableau de centroïdes couleur
+ *
+ * Parcours en largeur avec une file : chaque face entre une fois dans la file et chaque
+ * voisin est examiné une fois, soit O(F + E). Le parcours s'arrête quand la file est vide.
+ *
+ * @param   g               Graphe dual
+ * @param   numVertices     Nombre de sommets
+ * @param   selectedPoint   Point sélectionné
+ * @param   maxDistancePtr  Pointeur vers la distance maximale
+ * @return  Tableau de centroïdes couleur
+ */
+CentoideC *createCentoideArray(DualCSR *g, int numVertices, int selectedPoint, int *maxDistancePtr)
+{
+    CentoideC *centoideArray = (CentoideC *)allouer(numVertices * sizeof(CentoideC));
+    int *file = allouer(numVertices * sizeof(int));    //Chaque face y entre au plus une fois
+
+    for (int i = 0; i < numVertices; i++)  //Initialise les distances à -1 pour tous les sommets
+    {
+        centoideArray[i].distance = -1;
+    }
+
+    int depart = max(selectedPoint - 1, 0);
+    centoideArray[depart].distance = 0;  //Initialise la distance du sommet sélectionné à 0
+    *maxDistancePtr = 0;
+
+    int tete = 0, queue = 0;
+    file[queue++] = depart;
+
+    while (tete < queue)
+    {
+        int i = file[tete++];
+        int distance = centoideArray[i].distance + 1;
+        const int *voisins = voisinsCSR(g, i);
+        for (int k = 0; k < degreCSR(g, i); k++)
+        {
+            if (centoideArray[voisins[k]].distance == -1)  //Met à jour la distance du sommet voisin non visité
+            {
+                centoideArray[voisins[k]].distance = distance;
+                file[queue++] = voisins[k];
+            }
+        }
+    }
+    *maxDistancePtr = centoideArray[file[queue - 1]].distance;   //La file est rangée par distance croissante
+
+    free(file);
+    return centoideArray;   // Retourne le tableau de structures CentoideC
+}
+
+// bfs parallèle (direction optimisée)
+
+#define BFS_ALPHA 14    //Passe en ascendant quand les arêtes de la frontière dépassent 1/ALPHA des restantes
+#define BFS_BETA 24     //Revient en descendant quand la frontière a moins de numF/BETA faces
+
+int bfsParallele = 0;   //Option --bfs parallele
+int bfsStats = 0;       //Option --bfs-stats : affiche les statistiques par niveau
+
+typedef struct contexteBFS
+{
+    DualCSR *g;
+    int nbT;
+    int numMots;                //Mots de 64 bits des bitmaps
+    int *distance;
+    uint64_t *frontiere, *suivante;
+    int niveau;                 //Distance des faces découvertes pendant ce niveau
+    int ascendant;              //1 : bottom-up, 0 : top-down
+    int fini;
+    long long *nouveaux;        //Par thread : faces découvertes
+    long long *degres;          //Par thread : somme de leurs degrés
+    long long *examinees;       //Par thread : arêtes examinées
+    long long restantes;        //Arêtes des faces pas encore visitées
+    long long aretesFrontiere;  //Arêtes de la frontière courante
+    long long tailleFrontiere;
+    NiveauBFS *stats;
+    int numStats, capStats;
+    double debutNiveau;
+    pthread_barrier_t barriere;
+} ContexteBFS;
+
+typedef struct threadBFS
+{
+    ContexteBFS *ctx;
+    int id;
+} ThreadBFS;
+
+
+/**
+ * @brief   Un niveau de parcours descendant (top-down) : les faces de la frontière marquent
+ *          leurs voisins non visités. Plusieurs threads peuvent viser la même face, d'où le CAS.
+ */
+static void niveauDescendant(ContexteBFS *ctx, int m0, int m1, long long *nouveaux, long long *degres, long long *examinees)
+{
+    DualCSR *g = ctx->g;
+    for (int m = m0; m < m1; m++)
+    {
+        uint64_t mot = ctx->frontiere[m];
+        while (mot != 0)
+        {
+            int u = m * 64 + __builtin_ctzll(mot);
+            mot &= mot - 1;
+            const int *voisins = voisinsCSR(g, u);
+            int deg = degreCSR(g, u);
+            *examinees += deg;
+            for (int k = 0; k < deg; k++)
+            {
+                int v = voisins[k];
+                int attendu = -1;
+                if (ctx->distance[v] == -1 &&
+                    __atomic_compare_exchange_n(&ctx->distance[v], &attendu, ctx->niveau, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                {
+                    __atomic_fetch_or(&ctx->suivante[v / 64], 1ULL << (v % 64), __ATOMIC_RELAXED);
+                    (*nouveaux)++;
+                    *degres += degreCSR(g, v);
+                }
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief   Un niveau de parcours ascendant (bottom-up) : chaque face non visitée cherche un
+ *          voisin dans la frontière et s'arrête au premier. Chaque thread n'écrit que ses faces.
+ */
+static void niveauAscendant(ContexteBFS *ctx, int m0, int m1, long long *nouveaux, long long *degres, long long *examinees)
+{
+    DualCSR *g = ctx->g;
+    int fin = min(m1 * 64, g->numF);
+    for (int v = m0 * 64; v < fin; v++)
+    {
+        if (ctx->distance[v] != -1)
+            continue;
+        const int *voisins = voisinsCSR(g, v);
+        int deg = degreCSR(g, v);
+        for (int k = 0; k < deg; k++)
+        {
+            int u = voisins[k];
+            (*examinees)++;
+            if (ctx->frontiere[u / 64] & (1ULL << (u % 64)))
+            {
+                ctx->distance[v] = ctx->niveau;
+                ctx->suivante[v / 64] |= 1ULL << (v % 64);
+                (*nouveaux)++;
+                *degres += deg;
+                break;
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief   Bilan d'un niveau (thread 0, entre deux barrières) : statistiques, échange des
+ *          bitmaps et choix du sens du niveau suivant.
+ */
+static void finNiveauBFS(ContexteBFS *ctx)
+{
+    long long nouveaux = 0, degres = 0, examinees = 0;
+    for (int t = 0; t < ctx->nbT; t++)
+    {
+        nouveaux += ctx->nouveaux[t];
+        degres += ctx->degres[t];
+        examinees += ctx->examinees[t];
+    }
+
+    if (ctx->numStats == ctx->capStats)
+    {
+        ctx->capStats *= 2;
+        ctx->stats = realloc(ctx->stats, ctx->capStats * sizeof(NiveauBFS));
+    }
+    NiveauBFS *st = &ctx->stats[ctx->numStats++];
+    st->niveau = ctx->niveau;
+    st->ascendant = ctx->ascendant;
+    st->frontiere = ctx->tailleFrontiere;
+    st->decouvertes = nouveaux;
+    st->examinees = examinees;
+    double maintenant = tempsMur();
+    st->temps = maintenant - ctx->debutNiveau;
+    ctx->debutNiveau = maintenant;
+
+    uint64_t *x = ctx->frontiere;
+    ctx->frontiere = ctx->suivante;
+    ctx->suivante = x;
+    memset(ctx->suivante, 0, ctx->numMots * sizeof(uint64_t));
+
+    ctx->restantes -= degres;
+    ctx->aretesFrontiere = degres;
+    ctx->tailleFrontiere = nouveaux;
+    if (nouveaux == 0)
+        ctx->fini = 1;
+    else if (!ctx->ascendant && ctx->aretesFrontiere > ctx->restantes / BFS_ALPHA)   //Heuristique de Beamer
+        ctx->ascendant = 1;
+    else if (ctx->ascendant && ctx->tailleFrontiere < ctx->g->numF / BFS_BETA)
+        ctx->ascendant = 0;
+    ctx->niveau++;
+}
+
+
+void *travailBFS(void *arg)
+{
+    ThreadBFS *th = arg;
+    ContexteBFS *ctx = th->ctx;
+    int m0 = (int)((long long)ctx->numMots * th->id / ctx->nbT);    //Tranche de mots : aucun mot partagé
+    int m1 = (int)((long long)ctx->numMots * (th->id + 1) / ctx->nbT);
+
+    while (1)
+    {
+        pthread_barrier_wait(&ctx->barriere);
+        if (ctx->fini)
+            break;
+
+        long long nouveaux = 0, degres = 0, examinees = 0;
+        if (ctx->ascendant)
+            niveauAscendant(ctx, m0, m1, &nouveaux, &degres, &examinees);
+        else
+            niveauDescendant(ctx, m0, m1, &nouveaux, &degres, &examinees);
+        ctx->nouveaux[th->id] = nouveaux;
+        ctx->degres[th->id] = degres;
+        ctx->examinees[th->id] = examinees;
+
+        pthread_barrier_wait(&ctx->barriere);
+        if (th->id == 0)
+            finNiveauBFS(ctx);
+    }
+    return NULL;
+}
+
+
+/**
+ * @brief   Crée un tableau de centroïdes couleur avec un parcours en largeur parallèle
+ *
+ * Les frontières sont des bitmaps. Chaque niveau est descendant (la frontière pousse vers ses
+ * voisins) ou ascendant (les faces non visitées cherchent un parent dans la frontière) selon la
+ * taille de la frontière, comme chez Beamer. Les distances sont celles de createCentoideArray.
+ *
+ * @param   g               Graphe dual
+ * @param   numVertices     Nombre de sommets
+ * @param   selectedPoint   Point sélectionné
+ * @param   maxDistancePtr  Pointeur vers la distance maximale
+ * @param   stats           Statistiques par niveau (à libérer), peut être NULL
+ * @param   numNiveaux      Nombre de niveaux de stats
+ * @return  Tableau de centroïdes couleur
+ */
+CentoideC *createCentoideArrayParallele(DualCSR *g, int numVertices, int selectedPoint, int *maxDistancePtr,
+                                        NiveauBFS **stats, int *numNiveaux)
+{
+    ContexteBFS ctx;
+    ctx.g = g;
+    ctx.numMots = (numVertices + 63) / 64;
+    ctx.nbT = max(1, min(nbThreads, ctx.numMots));
+    ctx.distance = allouer(numVertices * sizeof(int));
+    ctx.frontiere = allouerZero(ctx.numMots, sizeof(uint64_t));
+    ctx.suivante = allouerZero(ctx.numMots, sizeof(uint64_t));
+    ctx.nouveaux = malloc(ctx.nbT * sizeof(long long));
+    ctx.degres = malloc(ctx.nbT * sizeof(long long));
+    ctx.examinees = malloc(ctx.nbT * sizeof(long long));
+    ctx.capStats = 64;
+    ctx.numStats = 0;
+    ctx.stats = malloc(ctx.capStats * sizeof(NiveauBFS));
+
+    for (int i = 0; i < numVertices; i++)
+        ctx.distance[i] = -1;
+    int depart = max(selectedPoint - 1, 0);
+    ctx.distance[depart] = 0;
+    ctx.frontiere[depart / 64] = 1ULL << (depart % 64);
+    ctx.niveau = 1;
+    ctx.ascendant = 0;
+    ctx.fini = 0;
+    ctx.restantes = 2LL * g->numAretes - degreCSR(g, depart);
+    ctx.aretesFrontiere = degreCSR(g, depart);
+    ctx.tailleFrontiere = 1;
+    ctx.debutNiveau = tempsMur();
+    pthread_barrier_init(&ctx.barriere, NULL, ctx.nbT);
+
+    pthread_t *threads = malloc(ctx.nbT * sizeof(pthread_t));
+    ThreadBFS *args = malloc(ctx.nbT * sizeof(ThreadBFS));
+    for (int t = 0; t < ctx.nbT; t++)
+    {
+        args[t].ctx = &ctx;
+        args[t].id = t;
+        pthread_create(&threads[t], NULL, travailBFS, &args[t]);
+    }
+    for (int t = 0; t < ctx.nbT; t++)
+        pthread_join(threads[t], NULL);
+    pthread_barrier_destroy(&ctx.barriere);
+
+    *maxDistancePtr = ctx.niveau - 2;    //Le dernier niveau n'a rien découvert
+    CentoideC *centoideArray = (CentoideC *)allouer(numVertices * sizeof(CentoideC));
+    for (int i = 0; i < numVertices; i++)
+        centoideArray[i].distance = ctx.distance[i];
+
+    if (stats != NULL)
+    {
+        *stats = ctx.stats;
+        *numNiveaux = ctx.numStats;
+    }
+    else
+        free(ctx.stats);
+    free(threads);
+    free(args);
+    free(ctx.distance);
+    free(ctx.frontiere);
+    free(ctx.suivante);
+    free(ctx.nouveaux);
+    free(ctx.degres);
+    free(ctx.examinees);
+    return centoideArray;
+}
+
+
+/**
+ * @brief   Affiche les statistiques par niveau d'un parcours parallèle.
+ */
+void afficherStatsBFS(NiveauBFS *stats, int numNiveaux)
+{
+    printf("niveau  sens  frontière  découvertes  arêtes examinées   temps (s)\n");
+    for (int i = 0; i < numNiveaux; i++)
+    {
+        printf("%6d  %4s  %9lld  %11lld  %16lld  %10.6f\n", stats[i].niveau, stats[i].ascendant ? "asc" : "desc",
+               stats[i].frontiere, stats[i].decouvertes, stats[i].examinees, stats[i].temps);
+    }
+}
+
+// bfs multi-source (bits parallèles)
+
+#define MS_MOTS 4                  //Mots de 64 bits par face : 256 sources par lot
+#define MS_LOT (64 * MS_MOTS)
+
+/**
+ * @brief   Parcours en largeur simultané de jusqu'à MS_LOT sources (MS-BFS).
+ *
+ * Chaque face porte trois ensembles de bits (un bit par source) : sources qui l'ont déjà
+ * atteinte, frontière du niveau courant, frontière du niveau suivant. Un niveau parcourt
+ * les faces de la frontière une seule fois pour toutes les sources : les voisins reçoivent
+ * visite & ~vu, soit MS_MOTS opérations sur 64 bits par arête au lieu d'un parcours par source.
+ * Les faces actives sont gardées dans une liste pour ne pas balayer tout le maillage à
+ * chaque niveau.
+ *
+ * @param   g           Graphe dual
+ * @param   sources     Faces de départ (indices à partir de 0), au plus MS_LOT
+ * @param   numSources  Nombre de sources
+ * @param   distances   Reçoit numSources lignes de g->numF distances (-1 : inaccessible)
+ * @return  Nombre de niveaux parcourus
+ */
+int bfsMultiSource(DualCSR *g, const int *sources, int numSources, int *distances)
+{
+    size_t n = g->numF;
+    int mots = max(1, min(MS_MOTS, (numSources + 63) / 64));
+    int pas = 3 * mots;    //Par face, côte à côte : vu, frontière paire, frontière impaire
+    uint64_t *etat = allouerZero(max(n, 1) * pas, sizeof(uint64_t));
+    int *liste = allouer(sizeof(int) * max(n, 1));             //Faces de la frontière courante
+    int *listeSuivante = allouer(sizeof(int) * max(n, 1));
+    int taille = 0, tailleSuivante = 0;
+
+    for (size_t i = 0; i < (size_t)numSources * n; i++)
+        distances[i] = -1;
+    for (int s = 0; s < numSources; s++)
+    {
+        uint64_t *e = &etat[(size_t)sources[s] * pas];
+        uint64_t bit = 1ULL << (s % 64);
+        int vide = 1;
+        for (int w = 0; w < mots; w++)
+            vide &= e[mots + w] == 0;
+        if (vide)
+            liste[taille++] = sources[s];
+        e[s / 64] |= bit;
+        e[mots + s / 64] |= bit;
+        distances[(size_t)s * n + sources[s]] = 0;
+    }
+
+    int niveau = 1;
+    for (; taille > 0; niveau++)
+    {
+        int cour = (niveau & 1) ? mots : 2 * mots;    //Décalage de la frontière courante
+        int suiv = (niveau & 1) ? 2 * mots : mots;
+        for (int i = 0; i < taille; i++)
+        {
+            int f = liste[i];
+            const uint64_t *vf = &etat[(size_t)f * pas + cour];
+            const int *voisins = voisinsCSR(g, f);
+            for (int k = 0; k < degreCSR(g, f); k++)
+            {
+                uint64_t *e = &etat[(size_t)voisins[k] * pas];
+                uint64_t avant = 0, nouveau = 0;
+                for (int w = 0; w < mots; w++)   //Toutes les sources en même temps
+                {
+                    uint64_t x = vf[w] & ~e[w];
+                    avant |= e[suiv + w];
+                    e[suiv + w] |= x;
+                    e[w] |= x;
+                    nouveau |= x;
+                }
+                if (nouveau != 0 && avant == 0)    //Première découverte de la face à ce niveau
+                    listeSuivante[tailleSuivante++] = voisins[k];
+            }
+        }
+
+        for (int i = 0; i < taille; i++)    //La frontière courante servira au niveau d'après
+            memset(&etat[(size_t)liste[i] * pas + cour], 0, mots * sizeof(uint64_t));
+        for (int i = 0; i < tailleSuivante; i++)
+        {
+            int f = listeSuivante[i];
+            for (int w = 0; w < mots; w++)
+            {
+                uint64_t x = etat[(size_t)f * pas + suiv + w];
+                while (x != 0)
+                {
+                    int s = w * 64 + __builtin_ctzll(x);
+                    distances[(size_t)s * n + f] = niveau;
+                    x &= x - 1;
+                }
+            }
+        }
+
+        int *l = liste;
+        liste = listeSuivante;
+        listeSuivante = l;
+        taille = tailleSuivante;
+        tailleSuivante = 0;
+    }
+
+    free(etat);
+    free(liste);
+    free(listeSuivante);
+    return niveau - 1;
+}
+
+/**
+ * @brief   Parcours en largeur depuis une seule source, écrit dans une ligne de la matrice
+ * @param   g           Graphe dual
+ * @param   source      Face de départ (indice à partir de 0)
+ * @param   distance    Reçoit g->numF distances (-1 : inaccessible)
+ * @param   file        Tampon d'au moins g->numF entiers
+ * @return  Nombre de niveaux parcourus
+ */
+int bfsSource(DualCSR *g, int source, int *distance, int *file)
+{
+    for (int i = 0; i < g->numF; i++)
+        distance[i] = -1;
+    int tete = 0, queue = 0;
+    distance[source] = 0;
+    file[queue++] = source;
+    while (tete < queue)
+    {
+        int f = file[tete++];
+        const int *voisins = voisinsCSR(g, f);
+        for (int k = 0; k < degreCSR(g, f); k++)
+        {
+            if (distance[voisins[k]] == -1)
+            {
+                distance[voisins[k]] = distance[f] + 1;
+                file[queue++] = voisins[k];
+            }
+        }
+    }
+    return distance[file[queue - 1]] + 1;
+}
+
+int msBits = 0;     //Option --multi-bfs bits : noyau à bits parallèles pour --graines
+
+typedef struct contexteMultiSource
+{
+    DualCSR *g;
+    const int *sources;     //Indices à partir de 0
+    int numSources;
+    int *distances;         //numSources lignes de g->numF distances
+    long long niveaux;
+} ContexteMultiSource;
+
+typedef struct threadMultiSource
+{
+    ContexteMultiSource *ctx;
+    int id, nbT;
+    long long niveaux;
+} ThreadMultiSource;
+
+void *travailMultiSource(void *arg)
+{
+    ThreadMultiSource *t = arg;
+    ContexteMultiSource *ctx = t->ctx;
+    t->niveaux = 0;
+    if (!msBits)
+    {
+        int *file = allouer(sizeof(int) * max(ctx->g->numF, 1));   //Réutilisée pour toutes les sources du thread
+        for (int s = t->id; s < ctx->numSources; s += t->nbT)
+            t->niveaux += bfsSource(ctx->g, ctx->sources[s], ctx->distances + (size_t)s * ctx->g->numF, file);
+        free(file);
+        return NULL;
+    }
+    for (int lot = t->id * MS_LOT; lot < ctx->numSources; lot += t->nbT * MS_LOT)   //Lots indépendants
+    {
+        int taille = min(MS_LOT, ctx->numSources - lot);
+        t->niveaux += bfsMultiSource(ctx->g, ctx->sources + lot, taille, ctx->distances + (size_t)lot * ctx->g->numF);
+    }
+    return NULL;
+}
+
+
+/**
+ * @brief   Distances depuis plusieurs sources, réparties sur les threads : une source à la fois
+ *          par thread (défaut) ou par lots de MS_LOT sources avec bfsMultiSource.
+ *
+ * Sur les graphes duaux de maillages (grand diamètre), les fronts de deux sources ne passent
+ * presque jamais par la même face au même niveau : le noyau à bits parallèles partage peu de
+ * travail et reste environ deux fois plus lent qu'un parcours par source (bunny, 256 graines).
+ * Il est gardé pour les graphes de petit diamètre ou les graines très regroupées.
+ * @param   g           Graphe dual
+ * @param   sources     Faces de départ (indices à partir de 0)
+ * @param   numSources  Nombre de sources
+ * @return  Matrice numSources x g->numF des distances (à libérer)
+ */
+int *distancesMultiSources(DualCSR *g, const int *sources, int numSources)
+{
+    ContexteMultiSource ctx = {g, sources, numSources, NULL, 0};
+    ctx.distances = allouer(sizeof(int) * (size_t)max(numSources, 1) * max(g->numF, 1));
+    int nbT = max(1, min(nbThreads, msBits ? (numSources + MS_LOT - 1) / MS_LOT : numSources));
+    pthread_t *threads = malloc(sizeof(pthread_t) * nbT);
+    ThreadMultiSource *args = malloc(sizeof(ThreadMultiSource) * nbT);
+    for (int t = 0; t < nbT; t++)
+    {
+        args[t] = (ThreadMultiSource){&ctx, t, nbT, 0};
+        pthread_create(&threads[t], NULL, travailMultiSource, &args[t]);
+    }
+    for (int t = 0; t < nbT; t++)
+    {
+        pthread_join(threads[t], NULL);
+        compteurNiveauxBFS += args[t].niveaux;
+    }
+    free(threads);
+    free(args);
+    return ctx.distances;
+}
+
+
+// composantes connexes
+
+/**
+ * @brief   Racine de x dans l'union-find, avec division des chemins (chaque nœud visité
+ *          pointe vers son grand-parent). Sans verrou : les pointeurs ne font que descendre
+ *          vers des indices plus petits, un échange raté laisse simplement le chemin plus long.
+ */
+static inline int ufTrouver(int *parent, int x)
+{
+    for (;;)
+    {
+        int p = __atomic_load_n(&parent[x], __ATOMIC_ACQUIRE);
+        if (p == x)
+            return x;
+        int gp = __atomic_load_n(&parent[p], __ATOMIC_ACQUIRE);
+        if (p != gp)
+            __atomic_compare_exchange_n(&parent[x], &p, gp, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+        x = gp;
+    }
+}
+
+/**
+ * @brief   Réunit les ensembles de a et b : la plus grande racine est accrochée à la plus
+ *          petite par compare-and-swap, on recommence si une autre union l'a devancé.
+ */
+static void ufUnir(int *parent, int a, int b)
+{
+    for (;;)
+    {
+        a = ufTrouver(parent, a);
+        b = ufTrouver(parent, b);
+        if (a == b)
+            return;
+        int grand = max(a, b), petit = min(a, b);
+        int attendu = grand;
+        if (__atomic_compare_exchange_n(&parent[grand], &attendu, petit, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+            return;
+    }
+}
+
+typedef struct contexteComposantes
+{
+    DualCSR *g;
+    int *parent;
+    int *composante;        //Numéro de composante de chaque face
+    int *distance;
+    int *ordre;             //Composantes par taille décroissante
+    int *sources;           //Face de départ de chaque composante
+    int numComposantes;
+    int prochaine;          //Prochaine composante à parcourir (compteur atomique)
+    int *maxDistances;      //Par thread
+} ContexteComposantes;
+
+typedef struct threadComposantes
+{
+    ContexteComposantes *ctx;
+    int id, nbT;
+} ThreadComposantes;
+
+void *travailUnion(void *arg)
+{
+    ThreadComposantes *t = arg;
+    DualCSR *g = t->ctx->g;
+    int debut = (int)((long long)g->numF * t->id / t->nbT);
+    int fin = (int)((long long)g->numF * (t->id + 1) / t->nbT);
+    for (int f = debut; f < fin; f++)
+    {
+        const int *voisins = voisinsCSR(g, f);
+        for (int k = 0; k < degreCSR(g, f); k++)
+            if (voisins[k] > f)     //Chaque arête duale une fois
+                ufUnir(t->ctx->parent, f, voisins[k]);
+    }
+    return NULL;
+}
+
+void *travailComposantes(void *arg)
+{
+    ThreadComposantes *t = arg;
+    ContexteComposantes *ctx = t->ctx;
+    DualCSR *g = ctx->g;
+    int *file = allouer(sizeof(int) * max(g->numF, 1));
+    ctx->maxDistances[t->id] = 0;
+    for (;;)
+    {
+        int k = __atomic_fetch_add(&ctx->prochaine, 1, __ATOMIC_RELAXED);
+        if (k >= ctx->numComposantes)
+            break;
+        int c = ctx->ordre[k];
+        int tete = 0, queue = 0;   //Parcours limité à la composante : les autres faces sont hors d'atteinte
+        ctx->distance[ctx->sources[c]] = 0;
+        file[queue++] = ctx->sources[c];
+        while (tete < queue)
+        {
+            int f = file[tete++];
+            const int *voisins = voisinsCSR(g, f);
+            for (int i = 0; i < degreCSR(g, f); i++)
+            {
+                if (ctx->distance[voisins[i]] == -1)
+                {
+                    ctx->distance[voisins[i]] = ctx->distance[f] + 1;
+                    file[queue++] = voisins[i];
+                }
+            }
+        }
+        ctx->maxDistances[t->id] = max(ctx->maxDistances[t->id], ctx->distance[file[queue - 1]]);
+    }
+    free(file);
+    return NULL;
+}
+
+
+/**
+ * @brief   Numérote les composantes connexes du graphe dual (union-find parallèle)
+ * @param   g               Graphe dual
+ * @param   numComposantes  Reçoit le nombre de composantes
+ * @return  Numéro de composante de chaque face, dans l'ordre de la plus petite face (à libérer)
+ */
+int *composantesConnexes(DualCSR *g, int *numComposantes)
+{
+    int nbT = max(1, min(nbThreads, g->numF));
+    int *parent = allouer(sizeof(int) * max(g->numF, 1));
+    for (int f = 0; f < g->numF; f++)
+        parent[f] = f;
+
+    ContexteComposantes ctx = {.g = g, .parent = parent};
+    pthread_t *threads = malloc(sizeof(pthread_t) * nbT);
+    ThreadComposantes *args = malloc(sizeof(ThreadComposantes) * nbT);
+    for (int t = 0; t < nbT; t++)
+    {
+        args[t] = (ThreadComposantes){&ctx, t, nbT};
+        pthread_create(&threads[t], NULL, travailUnion, &args[t]);
+    }
+    for (int t = 0; t < nbT; t++)
+        pthread_join(threads[t], NULL);
+
+    for (int f = 0; f < g->numF; f++)     //Chaque face pointe directement vers sa racine
+        parent[f] = ufTrouver(parent, f);
+    int *composante = allouer(sizeof(int) * max(g->numF, 1));
+    *numComposantes = 0;
+    for (int f = 0; f < g->numF; f++)     //La racine est la plus petite face de sa composante
+        composante[f] = (parent[f] == f) ? (*numComposantes)++ : composante[parent[f]];
+    free(parent);
+    free(threads);
+    free(args);
+    return composante;
+}
+
+
+/**
+ * @brief   Distances par composante : chaque composante est parcourue depuis sa propre source
+ *          (la graine habituelle pour la sienne, sa plus petite face pour les autres), en
+ *          parallèle, les plus grosses composantes d'abord. Aucune face ne reste à -1.
+ * @param   g               Graphe dual
+ * @param   numVertices     Nombre de faces
+ * @param   selectedPoint   Graine, comme pour createCentoideArray
+ * @param   maxDistancePtr  Reçoit la distance maximale
+ * @return  Tableau de centroïdes couleur
+ */
+CentoideC *createCentoideArrayComposantes(DualCSR *g, int numVertices, int selectedPoint, int *maxDistancePtr)
+{
+    ContexteComposantes ctx = {.g = g};
+    ctx.composante = composantesConnexes(g, &ctx.numComposantes);
+    int nbT = max(1, min(nbThreads, ctx.numComposantes));
+
+    int *taille = calloc(max(ctx.numComposantes, 1), sizeof(int));
+    ctx.sources = malloc(sizeof(int) * max(ctx.numComposantes, 1));
+    for (int f = numVertices - 1; f >= 0; f--)
+    {
+        taille[ctx.composante[f]]++;
+        ctx.sources[ctx.composante[f]] = f;    //Plus petite face
+    }
+    if (numVertices > 0)
+    {
+        int depart = max(selectedPoint - 1, 0);
+        ctx.sources[ctx.composante[depart]] = depart;
+    }
+
+    ctx.ordre = malloc(sizeof(int) * max(ctx.numComposantes, 1));   //Tri par taille décroissante (comptage)
+    int *compte = allouerZero(numVertices + 2, sizeof(int));
+    for (int c = 0; c < ctx.numComposantes; c++)
+        compte[numVertices - taille[c]]++;
+    for (int i = 1; i <= numVertices + 1; i++)
+        compte[i] += compte[i - 1];
+    for (int c = ctx.numComposantes - 1; c >= 0; c--)
+        ctx.ordre[--compte[numVertices - taille[c]]] = c;
+
+    int *distance = allouer(sizeof(int) * max(numVertices, 1));
+    for (int f = 0; f < numVertices; f++)
+        distance[f] = -1;
+    ctx.distance = distance;
+    ctx.maxDistances = calloc(nbT, sizeof(int));
+    pthread_t *threads = malloc(sizeof(pthread_t) * nbT);
+    ThreadComposantes *args = malloc(sizeof(ThreadComposantes) * nbT);
+    for (int t = 0; t < nbT; t++)
+    {
+        args[t] = (ThreadComposantes){&ctx, t, nbT};
+        pthread_create(&threads[t], NULL, travailComposantes, &args[t]);
+    }
+    *maxDistancePtr = 0;
+    for (int t = 0; t < nbT; t++)
+    {
+        pthread_join(threads[t], NULL);
+        *maxDistancePtr = max(*maxDistancePtr, ctx.maxDistances[t]);
+    }
+
+    printf("Composantes connexes : %d", ctx.numComposantes);
+    if (ctx.numComposantes > 0)
+        printf(" (la plus grande : %d faces)", taille[ctx.ordre[0]]);
+    printf("\n");
+
+    CentoideC *centoideArray = allouer(sizeof(CentoideC) * max(numVertices, 1));
+    for (int f = 0; f < numVertices; f++)
+        centoideArray[f].distance = distance[f];
+
+    free(distance);
+    free(ctx.composante);
+    free(ctx.sources);
+    free(ctx.ordre);
+    free(ctx.maxDistances);
+    free(taille);
+    free(compte);
+    free(threads);
+    free(args);
+    return centoideArray;
+}
+
+
+// distances géodésiques
+
+/**
+ * @brief   Tas radix monotone sur les bits des floats positifs.
+ *
+ * Pour des floats >= 0, l'ordre des motifs binaires (uint32) est celui des valeurs. Un
+ * élément va dans le seau du bit de poids fort où sa clé diffère de la dernière clé extraite :
+ * Dijkstra n'insère jamais de clé plus petite que celle-ci, chaque élément ne redescend donc
+ * qu'au plus 32 fois, soit O(32) amorti par opération au lieu de O(log n) pour un tas binaire.
+ */
+typedef struct tasRadix
+{
+    uint32_t dernier;       //Dernière clé extraite
+    uint64_t *seaux[33];    //Éléments (clé << 32 | face)
+    int taille[33], cap[33];
+    long long nombre;
+} TasRadix;
+
+static inline int seauRadix(uint32_t cle, uint32_t dernier)
+{
+    return cle == dernier ? 0 : 32 - __builtin_clz(cle ^ dernier);
+}
+
+static void radixPousser(TasRadix *t, uint32_t cle, int face)
+{
+    int b = seauRadix(cle, t->dernier);
+    if (t->taille[b] == t->cap[b])
+    {
+        t->cap[b] = max(16, t->cap[b] * 2);
+        t->seaux[b] = realloc(t->seaux[b], sizeof(uint64_t) * t->cap[b]);
+    }
+    t->seaux[b][t->taille[b]++] = ((uint64_t)cle << 32) | (uint32_t)face;
+    t->nombre++;
+}
+
+static uint64_t radixExtraire(TasRadix *t)
+{
+    if (t->taille[0] == 0)
+    {
+        int b = 1;
+        while (t->taille[b] == 0)
+            b++;
+        uint64_t plusPetit = t->seaux[b][0];    //Nouvelle référence : la plus petite clé du seau
+        for (int i = 1; i < t->taille[b]; i++)
+            if (t->seaux[b][i] < plusPetit)
+                plusPetit = t->seaux[b][i];
+        t->dernier = (uint32_t)(plusPetit >> 32);
+        int n = t->taille[b];
+        t->taille[b] = 0;
+        t->nombre -= n;
+        for (int i = 0; i < n; i++)    //Redistribution dans des seaux plus bas
+        {
+            uint64_t x = t->seaux[b][i];
+            radixPousser(t, (uint32_t)(x >> 32), (int)(uint32_t)x);
+        }
+    }
+    t->nombre--;
+    return t->seaux[0][--t->taille[0]];
+}
+
+
+/**
+ * @brief   Plus courts chemins pondérés sur le graphe dual (Dijkstra avec un tas radix) : le
+ *          poids d'une arête duale est la distance euclidienne entre les centres des deux faces.
+ * @param   g               Graphe dual
+ * @param   centoides       Centres des faces
+ * @param   source          Face de départ (indice à partir de 0)
+ * @param   maxDistance     Reçoit la plus grande distance atteinte
+ * @return  Distance de chaque face (-1 : inaccessible), à libérer
+ */
+float *distancesGeodesiques(DualCSR *g, Centoide *centoides, int source, float *maxDistance)
+{
+    float *distance = allouer(sizeof(float) * max(g->numF, 1));
+    char *fixe = allouerZero(max(g->numF, 1), 1);
+    for (int i = 0; i < g->numF; i++)
+        distance[i] = -1;
+    TasRadix t;
+    memset(&t, 0, sizeof(t));
+
+    *maxDistance = 0;
+    distance[source] = 0;
+    radixPousser(&t, 0, source);
+    while (t.nombre > 0)
+    {
+        uint64_t x = radixExtraire(&t);
+        int u = (int)(uint32_t)x;
+        if (fixe[u])    //Entrée périmée
+            continue;
+        fixe[u] = 1;
+        float du = distance[u];
+        *maxDistance = du;     //Les faces sortent par distance croissante
+        Vertex cu = centoides[u].centre;
+        const int *voisins = voisinsCSR(g, u);
+        for (int k = 0; k < degreCSR(g, u); k++)
+        {
+            int w = voisins[k];
+            if (fixe[w])
+                continue;
+            Vertex cw = centoides[w].centre;
+            float dx = cw.a - cu.a, dy = cw.b - cu.b, dz = cw.c - cu.c;
+            float nd = du + sqrtf(dx * dx + dy * dy + dz * dz);
+            if (distance[w] < 0 || nd < distance[w])
+            {
+                distance[w] = nd;
+                uint32_t cle;
+                memcpy(&cle, &nd, sizeof(cle));
+                radixPousser(&t, cle, w);
+            }
+        }
+    }
+
+    for (int b = 0; b < 33; b++)
+        free(t.seaux[b]);
+    free(fixe);
+    return distance;
+}
+
+
+// soudure des sommets
+
+/**
+ * @brief   Clé de hachage d'une cellule de la grille (coordonnées entières). Deux cellules
+ *          peuvent partager une clé : elles sont alors parcourues ensemble, la distance
+ *          exacte est toujours vérifiée.
+ */
+static inline uint64_t cleCellule(int64_t x, int64_t y, int64_t z)
+{
+    uint64_t h = (uint64_t)x * 0x9E3779B97F4A7C15ULL ^ (uint64_t)y * 0xC2B2AE3D27D4EB4FULL ^
+                 (uint64_t)z * 0x165667B19E3779F9ULL;
+    h ^= h >> 29;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 32;
+    return h;
+}
+
+typedef struct caseGrille
+{
+    uint64_t cle;
+    int debut, fin;         //Plage des sommets triés de cette clé, debut = -1 : case vide
+} CaseGrille;
+
+typedef struct contexteSoudure
+{
+    const Vertex *v;
+    int numV;
+    double eps;
+    Vertex bmin;
+    AreteCle *cles;         //Clé de cellule et indice (faceA) de chaque sommet
+    AreteCle *trie;         //Les mêmes, triées par clé : une cellule par plage
+    CaseGrille *table;      //Plages par clé, adressage ouvert
+    int bitsTable;
+    int *parent;            //Union-find des sommets
+} ContexteSoudure;
+
+typedef struct threadSoudure
+{
+    ContexteSoudure *ctx;
+    int id, nbT;
+} ThreadSoudure;
+
+/**
+ * @brief   Cellule d'un sommet dans la grille de pas 2 eps. Tout sommet à moins de eps est dans
+ *          cette cellule ou dans la voisine du côté de la moitié où tombe le sommet, sur chaque
+ *          axe : 8 cellules à examiner au lieu de 27.
+ * @param   c       Reçoit les coordonnées de la cellule
+ * @param   cote    Reçoit, par axe, le décalage (-1 ou +1) de la cellule voisine utile
+ */
+static inline void celluleSommet(const ContexteSoudure *ctx, int i, int64_t c[3], int cote[3])
+{
+    double p[3] = {((double)ctx->v[i].a - ctx->bmin.a) / (2 * ctx->eps),
+                   ((double)ctx->v[i].b - ctx->bmin.b) / (2 * ctx->eps),
+                   ((double)ctx->v[i].c - ctx->bmin.c) / (2 * ctx->eps)};
+    for (int k = 0; k < 3; k++)
+    {
+        c[k] = (int64_t)floor(p[k]);
+        cote[k] = (p[k] - c[k] < 0.5) ? -1 : 1;
+    }
+}
+
+static const CaseGrille *chercherCellule(const ContexteSoudure *ctx, uint64_t cle)
+{
+    size_t masque = ((size_t)1 << ctx->bitsTable) - 1;
+    for (size_t h = cle >> (64 - ctx->bitsTable);; h = (h + 1) & masque)
+    {
+        if (ctx->table[h].debut == -1)
+            return NULL;
+        if (ctx->table[h].cle == cle)
+            return &ctx->table[h];
+    }
+}
+
+void *travailClesSoudure(void *arg)
+{
+    ThreadSoudure *t = arg;
+    ContexteSoudure *ctx = t->ctx;
+    int debut = (int)((long long)ctx->numV * t->id / t->nbT);
+    int fin = (int)((long long)ctx->numV * (t->id + 1) / t->nbT);
+    for (int i = debut; i < fin; i++)
+    {
+        int64_t c[3];
+        int cote[3];
+        celluleSommet(ctx, i, c, cote);
+        ctx->cles[i].cle = cleCellule(c[0], c[1], c[2]);
+        ctx->cles[i].faceA = i;
+    }
+    return NULL;
+}
+
+/**
+ * @brief   Réunit chaque sommet avec les sommets d'indice supérieur à moins de eps, cherchés
+ *          dans les 8 cellules utiles. Parcours dans l'ordre trié : les sommets d'une même
+ *          cellule sont traités par le même thread, à la suite.
+ */
+void *travailUnionSoudure(void *arg)
+{
+    ThreadSoudure *t = arg;
+    ContexteSoudure *ctx = t->ctx;
+    double eps2 = ctx->eps * ctx->eps;
+    int debut = (int)((long long)ctx->numV * t->id / t->nbT);
+    int fin = (int)((long long)ctx->numV * (t->id + 1) / t->nbT);
+    int64_t dernier[3] = {0, 0, 0};
+    int dernierCote[3] = {0, 0, 0};     //0 : aucune cellule encore
+    const CaseGrille *voisines[8];
+    for (int k = debut; k < fin; k++)
+    {
+        int i = ctx->trie[k].faceA;
+        int64_t c[3];
+        int cote[3];
+        celluleSommet(ctx, i, c, cote);
+        if (memcmp(c, dernier, sizeof(c)) != 0 || memcmp(cote, dernierCote, sizeof(cote)) != 0)
+        {
+            //Les sommets d'une cellule se suivent : les 8 recherches servent à toute la série
+            for (int voisine = 0; voisine < 8; voisine++)
+            {
+                int64_t x = c[0] + ((voisine & 1) ? cote[0] : 0);
+                int64_t y = c[1] + ((voisine & 2) ? cote[1] : 0);
+                int64_t z = c[2] + ((voisine & 4) ? cote[2] : 0);
+                voisines[voisine] = chercherCellule(ctx, cleCellule(x, y, z));
+            }
+            memcpy(dernier, c, sizeof(c));
+            memcpy(dernierCote, cote, sizeof(cote));
+        }
+        for (int voisine = 0; voisine < 8; voisine++)
+        {
+            const CaseGrille *cg = voisines[voisine];
+            if (cg == NULL)
+                continue;
+            for (int q = cg->debut; q < cg->fin; q++)
+            {
+                int j = ctx->trie[q].faceA;
+                if (j <= i)
+                    continue;
+                double ex = (double)ctx->v[i].a - ctx->v[j].a;
+                double ey = (double)ctx->v[i].b - ctx->v[j].b;
+                double ez = (double)ctx->v[i].c - ctx->v[j].c;
+                if (ex * ex + ey * ey + ez * ez <= eps2)
+                    ufUnir(ctx->parent, i, j);
+            }
+        }
+    }
+    return NULL;
+}
+
+static void lancerSoudure(ContexteSoudure *ctx, int nbT, void *(*travail)(void *))
+{
+    pthread_t *threads = malloc(sizeof(pthread_t) * nbT);
+    ThreadSoudure *args = malloc(sizeof(ThreadSoudure) * nbT);
+    for (int t = 0; t < nbT; t++)
+    {
+        args[t] = (ThreadSoudure){ctx, t, nbT};
+        pthread_create(&threads[t], NULL, travail, &args[t]);
+    }
+    for (int t = 0; t < nbT; t++)
+        pthread_join(threads[t], NULL);
+    free(threads);
+    free(args);
+}
+
+
+#define SOUDURE_CELLULES_MAX 4503599627370496.0    //2^52 cellules par axe : floor reste exact et tient sur 64 bits
+
+int *rangSoudure = NULL;    //--souder : place de chaque face d'origine après soudure, -1 si retirée
+int numFacesSoudure = 0;    //Nombre de faces avant soudure
+
+/**
+ * @brief   Soude les sommets à moins de eps les uns des autres (option --souder), avant la
+ *          génération des arêtes : les faces séparées par une couture (UV, matériaux) deviennent
+ *          voisines dans le graphe dual.
+ *
+ * Grille uniforme de pas 2 eps : chaque sommet est comparé aux sommets des 8 cellules qui
+ * peuvent en contenir un à moins de eps, en parallèle, et les paires proches sont réunies dans l'union-find sans verrou des
+ * composantes connexes. Chaque groupe garde son sommet de plus petit indice, ce qui rend le
+ * résultat indépendant du nombre de threads. La relation est transitive : une chaîne de
+ * sommets espacés de moins de eps devient un seul sommet. Les faces sont renumérotées et
+ * celles qui deviennent dégénérées (deux sommets égaux) sont retirées : leurs numéros
+ * d'origine sont affichés et rangFaces garde la correspondance.
+ *
+ * @param   v           Tableau des sommets, compacté
+ * @param   numV        Nombre de sommets, mis à jour
+ * @param   f           Tableau des faces, compacté
+ * @param   numF        Nombre de faces, mis à jour
+ * @param   eps         Distance de soudure
+ * @param   rangFaces   Reçoit la nouvelle place de chaque face d'origine (-1 si retirée), NULL pour aucune
+ * @return  Nombre de sommets fusionnés, -1 si eps est trop petit pour la boîte englobante
+ */
+int souderSommets(Vertex *v, int *numV, Face *f, int *numF, float eps, int *rangFaces)
+{
+    double debut = tempsMur();
+    ContexteSoudure ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.v = v;
+    ctx.numV = *numV;
+    ctx.eps = eps;
+    Vertex bmax = {0, 0, 0};
+    if (ctx.numV > 0)
+        ctx.bmin = bmax = v[0];
+    for (int i = 1; i < ctx.numV; i++)
+    {
+        ctx.bmin.a = min(ctx.bmin.a, v[i].a);
+        ctx.bmin.b = min(ctx.bmin.b, v[i].b);
+        ctx.bmin.c = min(ctx.bmin.c, v[i].c);
+        bmax.a = max(bmax.a, v[i].a);
+        bmax.b = max(bmax.b, v[i].b);
+        bmax.c = max(bmax.c, v[i].c);
+    }
+    double etendue = max(max((double)bmax.a - ctx.bmin.a, (double)bmax.b - ctx.bmin.b), (double)bmax.c - ctx.bmin.c);
+    if (!(etendue / (2 * ctx.eps) < SOUDURE_CELLULES_MAX))    //Vrai aussi pour une étendue infinie
+    {
+        printf("Distance de soudure %g trop petite pour la boîte englobante (côté %g) : cellules hors des "
+               "entiers 64 bits\n", eps, etendue);
+        return -1;
+    }
+    int nbT = max(1, min(nbThreads, ctx.numV / 4096 + 1));   //Petits maillages : un seul thread
+
+    ctx.cles = allouer(sizeof(AreteCle) * max(ctx.numV, 1));
+    AreteCle *tmp = allouer(sizeof(AreteCle) * max(ctx.numV, 1));
+    lancerSoudure(&ctx, nbT, travailClesSoudure);
+    ctx.trie = trierRadixCles(ctx.cles, tmp, ctx.numV, 64);
+
+    ctx.bitsTable = 1;
+    while ((1LL << ctx.bitsTable) < 2LL * ctx.numV)
+        ctx.bitsTable++;
+    size_t masque = ((size_t)1 << ctx.bitsTable) - 1;
+    ctx.table = allouer(sizeof(CaseGrille) << ctx.bitsTable);
+    for (size_t h = 0; h <= masque; h++)
+        ctx.table[h].debut = -1;
+    for (int k = 0; k < ctx.numV;)
+    {
+        int fin = k + 1;
+        while (fin < ctx.numV && ctx.trie[fin].cle == ctx.trie[k].cle)
+            fin++;
+        size_t h = ctx.trie[k].cle >> (64 - ctx.bitsTable);
+        while (ctx.table[h].debut != -1)
+            h = (h + 1) & masque;
+        ctx.table[h] = (CaseGrille){ctx.trie[k].cle, k, fin};
+        k = fin;
+    }
+
+    ctx.parent = allouer(sizeof(int) * max(ctx.numV, 1));
+    for (int i = 0; i < ctx.numV; i++)
+        ctx.parent[i] = i;
+    lancerSoudure(&ctx, nbT, travailUnionSoudure);
+
+    //Nouveaux indices : la racine (plus petit indice du groupe) garde sa place relative
+    for (int i = 0; i < ctx.numV; i++)
+        ctx.parent[i] = ufTrouver(ctx.parent, i);
+    int *nouveau = (int *)tmp;      //Le tableau de travail du tri suffit (au moins 4 octets par sommet)
+    int n = 0;
+    for (int i = 0; i < ctx.numV; i++)
+    {
+        if (ctx.parent[i] == i)
+        {
+            v[n] = v[i];
+            nouveau[i] = n++;
+        }
+        else
+            nouveau[i] = nouveau[ctx.parent[i]];
+    }
+    int fusionnes = ctx.numV - n;
+    *numV = n;
+
+    int gardees = 0;
+    int retirees[20];       //Premières faces retirées, pour le rapport
+    int numRetirees = 0;
+    for (int i = 0; i < *numF; i++)
+    {
+        Face x = {nouveau[f[i].v1 - 1] + 1, nouveau[f[i].v2 - 1] + 1, nouveau[f[i].v3 - 1] + 1};
+        int garde = x.v1 != x.v2 && x.v2 != x.v3 && x.v1 != x.v3;
+        if (rangFaces != NULL)
+            rangFaces[i] = garde ? gardees : -1;
+        if (garde)
+            f[gardees++] = x;
+        else if (numRetirees < 20)
+            retirees[numRetirees++] = i + 1;
+    }
+    int degenerees = *numF - gardees;
+    *numF = gardees;
+
+    printf("Soudure : %d sommets fusionnés (%d -> %d), %d faces dégénérées retirées en %f s (%d thread%s)\n",
+           fusionnes, ctx.numV, n, degenerees, tempsMur() - debut, nbT, nbT > 1 ? "s" : "");
+    if (degenerees > 0)
+    {
+        printf("Faces retirées (numérotation d'origine, les suivantes sont décalées) :");
+        for (int i = 0; i < numRetirees; i++)
+            printf(" %d", retirees[i]);
+        printf(degenerees > numRetirees ? " ...\n" : "\n");
+    }
+    free(ctx.cles);
+    free(tmp);
+    free(ctx.table);
+    free(ctx.parent);
+    return fusionnes;
+}
+
+
+// réordonnancement (courbes de remplissage)
+
+/**
+ * @brief   Permutations appliquées par --reordonner. Les faces sont renumérotées en interne,
+ *          les sorties sont réécrites dans la numérotation d'origine.
+ */
+typedef struct reordonnancement
+{
+    int *origineSommets;    //Indice d'origine (à partir de 0) de chaque sommet réordonné
+    int *origineFaces;      //Indice d'origine de chaque face réordonnée
+    int *rangFaces;         //Inverse : place de chaque face d'origine
+    int hilbert;            //0 : Morton, 1 : Hilbert
+} Reordonnancement;
+
+Reordonnancement *reordre = NULL;   //Option --reordonner, NULL sans réordonnancement
+
+#define COURBE_BITS 16      //Bits par axe, codes sur 48 bits
+
+/**
+ * @brief   Intercale deux zéros entre chaque bit de x (16 bits utiles)
+ */
+static uint64_t etalerBits(uint32_t x)
+{
+    uint64_t r = x & 0xffff;
+    r = (r | r << 16) & 0x0000ff0000ffULL;
+    r = (r | r << 8) & 0x00f00f00f00fULL;
+    r = (r | r << 4) & 0x0c30c30c30c3ULL;
+    r = (r | r << 2) & 0x249249249249ULL;
+    return r;
+}
+
+/**
+ * @brief   Code de la courbe de Hilbert ou de Morton d'un point quantifié
+ *
+ * Hilbert : transformation de Skilling (coordonnées vers forme transposée), dont les bits
+ * s'entrelacent ensuite comme un code de Morton.
+ */
+static uint64_t codeCourbe(uint32_t x[3], int hilbert)
+{
+    if (hilbert)
+    {
+        for (uint32_t q = 1u << (COURBE_BITS - 1); q > 1; q >>= 1)
+        {
+            uint32_t p = q - 1;
+            for (int i = 0; i < 3; i++)
+            {
+                if (x[i] & q)
+                    x[0] ^= p;
+                else
+                {
+                    uint32_t t = (x[0] ^ x[i]) & p;
+                    x[0] ^= t;
+                    x[i] ^= t;
+                }
+            }
+        }
+        x[1] ^= x[0];   //Code de Gray
+        x[2] ^= x[1];
+        uint32_t t = 0;
+        for (uint32_t q = 1u << (COURBE_BITS - 1); q > 1; q >>= 1)
+            if (x[2] & q)
+                t ^= q - 1;
+        for (int i = 0; i < 3; i++)
+            x[i] ^= t;
+    }
+    return etalerBits(x[0]) << 2 | etalerBits(x[1]) << 1 | etalerBits(x[2]);
+}
+
+/**
+ * @brief   Ordre de parcours de points le long de la courbe, dans la boîte englobante donnée
+ * @param   points  Points (sommets ou centres des faces)
+ * @param   n       Nombre de points
+ * @param   bmin    Coin minimal de la boîte
+ * @param   bmax    Coin maximal de la boîte
+ * @param   hilbert 1 pour Hilbert, 0 pour Morton
+ * @return  ordre[k] = indice du k-ième point sur la courbe (à libérer)
+ */
+int *ordreCourbe(const Vertex *points, int n, Vertex bmin, Vertex bmax, int hilbert)
+{
+    AreteCle *cles = allouer(sizeof(AreteCle) * max(n, 1));
+    AreteCle *tmp = allouer(sizeof(AreteCle) * max(n, 1));
+    float echelle = (1 << COURBE_BITS) - 1;
+    float ex = bmax.a > bmin.a ? echelle / (bmax.a - bmin.a) : 0;
+    float ey = bmax.b > bmin.b ? echelle / (bmax.b - bmin.b) : 0;
+    float ez = bmax.c > bmin.c ? echelle / (bmax.c - bmin.c) : 0;
+    for (int i = 0; i < n; i++)
+    {
+        uint32_t x[3] = {(uint32_t)((points[i].a - bmin.a) * ex), (uint32_t)((points[i].b - bmin.b) * ey),
+                         (uint32_t)((points[i].c - bmin.c) * ez)};
+        for (int k = 0; k < 3; k++)
+            x[k] = min(x[k], (uint32_t)echelle);
+        cles[i].cle = codeCourbe(x, hilbert);
+        cles[i].faceA = i;
+    }
+    AreteCle *trie = trierRadixCles(cles, tmp, n, 3 * COURBE_BITS);   //Stable : égalités dans l'ordre d'origine
+
+    int *ordre = allouer(sizeof(int) * max(n, 1));
+    for (int k = 0; k < n; k++)
+        ordre[k] = trie[k].faceA;
+    free(cles);
+    free(tmp);
+    return ordre;
+}
+
+
+/**
+ * @brief   Réordonne sommets et faces le long d'une courbe de Morton ou de Hilbert : sommets
+ *          selon leur position, faces selon leur centre. Les indices des faces sont renumérotés,
+ *          l'ordre des sommets dans chaque face est conservé (mêmes centroïdes au bit près).
+ *
+ * @param   v       Tableau des sommets, remplacé
+ * @param   numV    Nombre de sommets
+ * @param   f       Tableau des faces, remplacé
+ * @param   numF    Nombre de faces
+ * @param   hilbert 1 pour Hilbert, 0 pour Morton
+ * @return  Permutations appliquées (à libérer avec libererReordonnancement)
+ */
+Reordonnancement *reordonnerMaillage(Vertex **v, int numV, Face **f, int numF, int hilbert)
+{
+    Reordonnancement *r = malloc(sizeof(Reordonnancement));
+    r->hilbert = hilbert;
+    Vertex bmin = {0, 0, 0}, bmax = {0, 0, 0};
+    if (numV > 0)
+        bmin = bmax = (*v)[0];
+    for (int i = 1; i < numV; i++)
+    {
+        bmin.a = min(bmin.a, (*v)[i].a);
+        bmin.b = min(bmin.b, (*v)[i].b);
+        bmin.c = min(bmin.c, (*v)[i].c);
+        bmax.a = max(bmax.a, (*v)[i].a);
+        bmax.b = max(bmax.b, (*v)[i].b);
+        bmax.c = max(bmax.c, (*v)[i].c);
+    }
+
+    //Sommets
+    r->origineSommets = ordreCourbe(*v, numV, bmin, bmax, hilbert);
+    Vertex *nv = allouer(sizeof(Vertex) * max(numV, 1));
+    int *rangSommets = allouer(sizeof(int) * max(numV, 1));
+    for (int k = 0; k < numV; k++)
+    {
+        nv[k] = (*v)[r->origineSommets[k]];
+        rangSommets[r->origineSommets[k]] = k;
+    }
+    free(*v);
+    *v = nv;
+
+    //Faces, le long de la même courbe que leurs sommets
+    Vertex *centres = allouer(sizeof(Vertex) * max(numF, 1));
+    for (int i = 0; i < numF; i++)
+    {
+        Face *x = &(*f)[i];
+        x->v1 = rangSommets[x->v1 - 1] + 1;
+        x->v2 = rangSommets[x->v2 - 1] + 1;
+        x->v3 = rangSommets[x->v3 - 1] + 1;
+        centres[i].a = (nv[x->v1 - 1].a + nv[x->v2 - 1].a + nv[x->v3 - 1].a) / 3;
+        centres[i].b = (nv[x->v1 - 1].b + nv[x->v2 - 1].b + nv[x->v3 - 1].b) / 3;
+        centres[i].c = (nv[x->v1 - 1].c + nv[x->v2 - 1].c + nv[x->v3 - 1].c) / 3;
+    }
+    r->origineFaces = ordreCourbe(centres, numF, bmin, bmax, hilbert);
+    Face *nf = allouer(sizeof(Face) * max(numF, 1));
+    r->rangFaces = allouer(sizeof(int) * max(numF, 1));
+    for (int k = 0; k < numF; k++)
+    {
+        nf[k] = (*f)[r->origineFaces[k]];
+        r->rangFaces[r->origineFaces[k]] = k;
+    }
+    free(*f);
+    *f = nf;
+
+    free(centres);
+    free(rangSommets);
+    return r;
+}
+
+
+/**
+ * @brief   Remet les arêtes produites sur le maillage réordonné dans l'ordre des faces et la
+ *          numérotation des sommets d'origine. Le moteur d'appariement rend alors exactement les
+ *          paires d'une exécution sans --reordonner (même ordre, donc même graine par défaut).
+ * @param   r       Réordonnancement
+ * @param   a       Arêtes du maillage réordonné (libérées)
+ * @param   numF    Nombre de faces
+ * @return  Arêtes dans la numérotation d'origine
+ */
+Arete *aretesOrigine(const Reordonnancement *r, Arete *a, int numF)
+{
+    Arete *o = allouer(sizeof(Arete) * 3 * max(numF, 1));
+    for (int i = 0; i < numF; i++)
+    {
+        const Arete *x = &a[3 * (size_t)r->rangFaces[i]];
+        for (int k = 0; k < 3; k++)
+        {
+            int n1 = r->origineSommets[x[k].num1 - 1] + 1;
+            int n2 = r->origineSommets[x[k].num2 - 1] + 1;
+            o[3 * i + k].num1 = min(n1, n2);
+            o[3 * i + k].num2 = max(n1, n2);
+            o[3 * i + k].faceA = i;
+        }
+    }
+    free(a);
+    return o;
+}
+
+void libererReordonnancement(Reordonnancement *r)
+{
+    free(r->origineSommets);
+    free(r->origineFaces);
+    free(r->rangFaces);
+    free(r);
+}
+
+
+#define CACHE_ENSEMBLES 1024
+#define CACHE_VOIES 4
+
+/**
+ * @brief   Cache simulé : 1024 ensembles de 4 voies LRU, lignes de 64 octets (256 Ko, la
+ *          taille d'un L2). Sert à comparer deux ordres sans compteurs matériels.
+ */
+typedef struct cacheSimule
+{
+    uint64_t lignes[CACHE_ENSEMBLES][CACHE_VOIES];  //0 : voie vide, la plus récente en tête
+    long long defauts;
+} CacheSimule;
+
+/**
+ * @brief   Accès à l'octet position du tableau numéro tableau (les tableaux sont supposés
+ *          alignés sur des pages, comme les grandes allocations de malloc)
+ */
+static void accederCache(CacheSimule *c, int tableau, size_t position)
+{
+    uint64_t ligne = (((uint64_t)tableau << 40) + position) / 64 + 1;
+    uint64_t *e = c->lignes[ligne % CACHE_ENSEMBLES];
+    int w = 0;
+    while (w < CACHE_VOIES - 1 && e[w] != ligne)
+        w++;
+    if (e[w] != ligne)
+        c->defauts++;
+    memmove(e + 1, e, w * sizeof(uint64_t));
+    e[0] = ligne;
+}
+
+/**
+ * @brief   Défauts de cache simulés des phases qui suivent l'ordre de la courbe, pour les faces
+ *          rangées selon place (place[f] : position de la face f en mémoire, identité pour
+ *          l'ordre courant)
+ *
+ * Centroïdes : lecture des coordonnées SoA des trois sommets de chaque face. BFS : parcours
+ * depuis source, bornes et voisins de chaque face, distance de chaque voisin. L'appariement
+ * n'est pas simulé : il se fait dans l'ordre du fichier (voir aretesOrigine).
+ *
+ * @param   f               Faces réordonnées
+ * @param   g               Graphe dual réordonné
+ * @param   placeSommet     Position de chaque sommet (indice à partir de 0) en mémoire
+ * @param   place           Position de chaque face en mémoire
+ * @param   source          Face de départ du parcours
+ * @param   defauts         Reçoit les défauts des deux phases
+ */
+static void simulerPhases(const Face *f, DualCSR *g, const int *placeSommet, const int *place, int source,
+                          long long defauts[2])
+{
+    int n = g->numF;
+    int *parPlace = malloc(sizeof(int) * max(n, 1));    //Face rangée à chaque position
+    int *debutPlace = malloc(sizeof(int) * (n + 1));     //CSR tel qu'il serait construit dans cet ordre
+    for (int i = 0; i < n; i++)
+        parPlace[place[i]] = i;
+    debutPlace[0] = 0;
+    for (int p = 0; p < n; p++)
+        debutPlace[p + 1] = debutPlace[p] + degreCSR(g, parPlace[p]);
+    CacheSimule *c = malloc(sizeof(CacheSimule));
+
+    memset(c, 0, sizeof(CacheSimule));
+    for (int p = 0; p < n; p++)
+    {
+        const int *s = &f[parPlace[p]].v1;
+        accederCache(c, 0, p * sizeof(Face));
+        for (int k = 0; k < 3; k++)
+            for (int axe = 0; axe < 3; axe++)
+                accederCache(c, 1 + axe, (placeSommet[s[k] - 1] + 1) * sizeof(float));
+    }
+    defauts[0] = c->defauts;
+
+    memset(c, 0, sizeof(CacheSimule));
+    char *vu = calloc(max(n, 1), 1);
+    int *file = malloc(sizeof(int) * max(n, 1));
+    int tete = 0, queue = 0;
+    if (n > 0)
+    {
+        vu[source] = 1;
+        file[queue++] = source;
+    }
+    while (tete < queue)
+    {
+        int x = file[tete++];
+        accederCache(c, 0, place[x] * sizeof(int));
+        const int *voisins = voisinsCSR(g, x);
+        for (int k = 0; k < degreCSR(g, x); k++)
+        {
+            accederCache(c, 1, (debutPlace[place[x]] + k) * sizeof(int));
+            accederCache(c, 2, place[voisins[k]] * sizeof(CentoideC));
+            if (!vu[voisins[k]])
+            {
+                vu[voisins[k]] = 1;
+                file[queue++] = voisins[k];
+            }
+        }
+    }
+    defauts[1] = c->defauts;
+
+    free(vu);
+    free(file);
+    free(c);
+    free(parPlace);
+    free(debutPlace);
+}
+
+
+/**
+ * @brief   Compare les défauts de cache simulés des phases centroïdes et BFS entre l'ordre
+ *          d'origine du fichier et l'ordre de la courbe. Avec --profile, le tableau des phases
+ *          donne en plus les défauts LLC mesurés de l'exécution réelle.
+ */
+void rapportLocalite(const Reordonnancement *r, const Face *f, int numV, DualCSR *g, int source)
+{
+    int n = g->numF;
+    int *identite = malloc(sizeof(int) * max(max(n, numV), 1));
+    for (int i = 0; i < max(n, numV); i++)
+        identite[i] = i;
+    long long avant[2], apres[2];
+    simulerPhases(f, g, r->origineSommets, r->origineFaces, source, avant);
+    simulerPhases(f, g, identite, identite, source, apres);
+    free(identite);
+
+    static const char *noms[2] = {"centroides", "bfs"};
+    printf("Réordonnancement %s : défauts de cache simulés (256 Ko, 4 voies, lignes de 64 o)\n",
+           r->hilbert ? "hilbert" : "morton");
+    printf("%-14s %12s %12s %10s\n", "phase", "origine", "courbe", "réduction");
+    for (int k = 0; k < 2; k++)
+        printf("%-14s %12lld %12lld %9.1f %%\n", noms[k], avant[k], apres[k],
+               avant[k] > 0 ? 100.0 * (avant[k] - apres[k]) / avant[k] : 0.0);
+    printf("appariement : ordre du fichier, pour garder la graine et les sorties d'une exécution sans courbe\n");
+}
+
+
+// graphe dual dynamique
+
+/**
+ * @brief   Graphe dual modifiable face par face.
+ *
+ * Les arêtes du maillage sont rangées dans une table de hachage (sondage linéaire, clé
+ * cleArete) qui garde, pour chaque arête, la liste de ses faces dans l'ordre d'arrivée.
+ * Comme pour triHash, la première face est appariée avec chacune des suivantes : les voisins
+ * d'une face se déduisent donc de ses trois arêtes, sans liste d'adjacence à maintenir.
+ * Les faces retirées gardent leur indice (les indices restent stables pendant l'édition).
+ */
+typedef struct grapheDynamique
+{
+    Face *faces;
+    char *vivante;
+    int numF, capF, numVivantes;
+
+    uint64_t *cles;             //Clé de l'arête, 0 : case vide (les sommets commencent à 1)
+    int *tete, *queue;          //Liste des faces de l'arête (nœuds)
+    int bits, numCles;
+
+    int *noeudFace, *noeudSuivant;
+    int capNoeuds, numNoeuds, noeudLibre;   //Nœuds libérés chaînés par noeudSuivant
+
+    int *distance;              //Distance à la source, -1 : inaccessible ou retirée
+    int source;
+    int graine;                 //f1 de la dernière arête duale créée
+
+    int *voisins, capVoisins;   //Tampon de voisinsDynamiques
+    uint64_t *tas;              //File de priorité (distance << 32 | face) des réparations
+    int tailleTas, capTas;
+    char *invalide;             //Marques de retirerFace, remises à zéro après chaque réparation
+    int *invalides, capInvalides;   //Faces marquées pendant la réparation en cours
+    long long reparees;         //Faces dont la distance a été recalculée
+} GrapheDynamique;
+
+
+static uint64_t cleFace(Face f, int k)
+{
+    int a = k == 0 ? f.v1 : k == 1 ? f.v2 : f.v1;
+    int b = k == 0 ? f.v2 : f.v3;
+    return cleArete((Arete){min(a, b), max(a, b), 0});
+}
+
+static size_t chercherCle(GrapheDynamique *gd, uint64_t cle)
+{
+    size_t masque = ((size_t)1 << gd->bits) - 1;
+    size_t h = hashArete(cle, gd->bits);
+    while (gd->cles[h] != 0 && gd->cles[h] != cle)
+        h = (h + 1) & masque;
+    return h;
+}
+
+static void agrandirTableDynamique(GrapheDynamique *gd)
+{
+    uint64_t *cles = gd->cles;
+    int *tete = gd->tete, *queue = gd->queue;
+    size_t ancienne = (size_t)1 << gd->bits;
+
+    gd->bits++;
+    gd->cles = calloc((size_t)1 << gd->bits, sizeof(uint64_t));
+    gd->tete = malloc(sizeof(int) * ((size_t)1 << gd->bits));
+    gd->queue = malloc(sizeof(int) * ((size_t)1 << gd->bits));
+    for (size_t i = 0; i < ancienne; i++)
+    {
+        if (cles[i] == 0)
+            continue;
+        size_t h = chercherCle(gd, cles[i]);
+        gd->cles[h] = cles[i];
+        gd->tete[h] = tete[i];
+        gd->queue[h] = queue[i];
+    }
+    free(cles);
+    free(tete);
+    free(queue);
+}
+
+static int nouveauNoeud(GrapheDynamique *gd, int face)
+{
+    int n;
+    if (gd->noeudLibre != -1)
+    {
+        n = gd->noeudLibre;
+        gd->noeudLibre = gd->noeudSuivant[n];
+    }
+    else
+    {
+        if (gd->numNoeuds == gd->capNoeuds)
+        {
+            gd->capNoeuds *= 2;
+            gd->noeudFace = realloc(gd->noeudFace, sizeof(int) * gd->capNoeuds);
+            gd->noeudSuivant = realloc(gd->noeudSuivant, sizeof(int) * gd->capNoeuds);
+        }
+        n = gd->numNoeuds++;
+    }
+    gd->noeudFace[n] = face;
+    gd->noeudSuivant[n] = -1;
+    return n;
+}
+
+
+/**
+ * @brief   Ajoute la face à la liste de l'arête
+ * @return  Première face de l'arête (la face ajoutée y est appariée), -1 si l'arête est nouvelle
+ */
+static int lierArete(GrapheDynamique *gd, uint64_t cle, int face)
+{
+    if ((size_t)(gd->numCles + 1) * 2 > ((size_t)1 << gd->bits))   //Facteur de charge <= 0.5
+        agrandirTableDynamique(gd);
+    size_t h = chercherCle(gd, cle);
+    int n = nouveauNoeud(gd, face);
+    if (gd->cles[h] == 0)
+    {
+        gd->cles[h] = cle;
+        gd->tete[h] = gd->queue[h] = n;
+        gd->numCles++;
+        return -1;
+    }
+    gd->noeudSuivant[gd->queue[h]] = n;
+    gd->queue[h] = n;
+    int premiere = gd->noeudFace[gd->tete[h]];
+    gd->graine = premiere;
+    return premiere;
+}
+
+
+/**
+ * @brief   Retire la case h en décalant les suivantes (pas de pierre tombale en sondage linéaire)
+ */
+static void retirerCase(GrapheDynamique *gd, size_t h)
+{
+    size_t masque = ((size_t)1 << gd->bits) - 1;
+    size_t j = h;
+    gd->cles[h] = 0;
+    for (;;)
+    {
+        j = (j + 1) & masque;
+        if (gd->cles[j] == 0)
+            break;
+        size_t k = hashArete(gd->cles[j], gd->bits);
+        if ((j > h && (k <= h || k > j)) || (j < h && k <= h && k > j))   //La case vide coupe sa chaîne
+        {
+            gd->cles[h] = gd->cles[j];
+            gd->tete[h] = gd->tete[j];
+            gd->queue[h] = gd->queue[j];
+            gd->cles[j] = 0;
+            h = j;
+        }
+    }
+    gd->numCles--;
+}
+
+
+/**
+ * @brief   Retire une occurrence de la face de la liste de l'arête
+ * @return  Nouvelle première face si la face retirée était la première et que l'arête a
+ *          encore au moins deux faces (de nouvelles arêtes duales apparaissent), -1 sinon
+ */
+static int delierArete(GrapheDynamique *gd, uint64_t cle, int face)
+{
+    size_t h = chercherCle(gd, cle);
+    if (gd->cles[h] == 0)
+        return -1;
+    int precedent = -1, n = gd->tete[h];
+    while (n != -1 && gd->noeudFace[n] != face)
+    {
+        precedent = n;
+        n = gd->noeudSuivant[n];
+    }
+    if (n == -1)
+        return -1;
+
+    if (precedent == -1)
+        gd->tete[h] = gd->noeudSuivant[n];
+    else
+        gd->noeudSuivant[precedent] = gd->noeudSuivant[n];
+    if (gd->queue[h] == n)
+        gd->queue[h] = precedent;
+    gd->noeudSuivant[n] = gd->noeudLibre;
+    gd->noeudLibre = n;
+
+    if (gd->tete[h] == -1)
+    {
+        retirerCase(gd, h);
+        return -1;
+    }
+    if (precedent == -1 && gd->noeudSuivant[gd->tete[h]] != -1)
+        return gd->noeudFace[gd->tete[h]];
+    return -1;
+}
+
+
+/**
+ * @brief   Voisins d'une face dans le graphe dual (un voisin peut apparaître deux fois si
+ *          deux faces partagent deux arêtes, comme dans les paires des moteurs)
+ * @param   gd  Graphe dynamique
+ * @param   f   Face vivante
+ * @return  Nombre de voisins, rangés dans gd->voisins
+ */
+int voisinsDynamiques(GrapheDynamique *gd, int f)
+{
+    int n = 0;
+    for (int k = 0; k < 3; k++)
+    {
+        size_t h = chercherCle(gd, cleFace(gd->faces[f], k));
+        if (gd->cles[h] == 0)
+            continue;
+        int premiere = gd->noeudFace[gd->tete[h]];
+        for (int x = gd->tete[h]; x != -1; x = gd->noeudSuivant[x])
+        {
+            int autre = gd->noeudFace[x];
+            if (autre == f || (premiere != f && autre != premiere))    //Seule la première est reliée aux autres
+                continue;
+            if (n == gd->capVoisins)
+            {
+                gd->capVoisins *= 2;
+                gd->voisins = realloc(gd->voisins, sizeof(int) * gd->capVoisins);
+            }
+            gd->voisins[n++] = autre;
+        }
+    }
+    return n;
+}
+
+
+static void tasDynPousser(GrapheDynamique *gd, int distance, int face)
+{
+    if (gd->tailleTas == gd->capTas)
+    {
+        gd->capTas *= 2;
+        gd->tas = realloc(gd->tas, sizeof(uint64_t) * gd->capTas);
+    }
+    uint64_t x = ((uint64_t)(uint32_t)distance << 32) | (uint32_t)face;
+    int i = gd->tailleTas++;
+    while (i > 0 && gd->tas[(i - 1) / 2] > x)
+    {
+        gd->tas[i] = gd->tas[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    gd->tas[i] = x;
+}
+
+static uint64_t tasDynExtraire(GrapheDynamique *gd)
+{
+    uint64_t racine = gd->tas[0];
+    uint64_t x = gd->tas[--gd->tailleTas];
+    int i = 0;
+    for (;;)
+    {
+        int f = 2 * i + 1;
+        if (f >= gd->tailleTas)
+            break;
+        if (f + 1 < gd->tailleTas && gd->tas[f + 1] < gd->tas[f])
+            f++;
+        if (gd->tas[f] >= x)
+            break;
+        gd->tas[i] = gd->tas[f];
+        i = f;
+    }
+    gd->tas[i] = x;
+    return racine;
+}
+
+
+/**
+ * @brief   Propage les distances depuis les faces déjà dans le tas (Dijkstra à poids 1) :
+ *          chaque face n'est relâchée que si sa distance baisse.
+ */
+static void propagerDistances(GrapheDynamique *gd)
+{
+    while (gd->tailleTas > 0)
+    {
+        uint64_t x = tasDynExtraire(gd);
+        int d = (int)(x >> 32), u = (int)(uint32_t)x;
+        if (gd->distance[u] != d)   //Entrée périmée
+            continue;
+        int n = voisinsDynamiques(gd, u);
+        for (int k = 0; k < n; k++)
+        {
+            int w = gd->voisins[k];
+            if (gd->distance[w] == -1 || gd->distance[w] > d + 1)
+            {
+                gd->distance[w] = d + 1;
+                gd->reparees++;
+                tasDynPousser(gd, d + 1, w);
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief   Recalcule toutes les distances depuis gd->source (parcours en largeur complet)
+ */
+void distancesCompletes(GrapheDynamique *gd)
+{
+    for (int i = 0; i < gd->numF; i++)
+        gd->distance[i] = -1;
+    if (gd->source < 0 || !gd->vivante[gd->source])
+        return;
+    int *file = malloc(sizeof(int) * gd->numF);
+    int tete = 0, queue = 0;
+    gd->distance[gd->source] = 0;
+    file[queue++] = gd->source;
+    while (tete < queue)
+    {
+        int u = file[tete++];
+        int n = voisinsDynamiques(gd, u);
+        for (int k = 0; k < n; k++)
+        {
+            if (gd->distance[gd->voisins[k]] == -1)
+            {
+                gd->distance[gd->voisins[k]] = gd->distance[u] + 1;
+                file[queue++] = gd->voisins[k];
+            }
+        }
+    }
+    gd->reparees += queue;
+    free(file);
+}
+
+
+static int insererFace(GrapheDynamique *gd, Face nf)
+{
+    if (gd->numF == gd->capF)
+    {
+        gd->capF = max(16, gd->capF * 2);
+        gd->faces = realloc(gd->faces, sizeof(Face) * gd->capF);
+        gd->vivante = realloc(gd->vivante, gd->capF);
+        gd->distance = realloc(gd->distance, sizeof(int) * gd->capF);
+        gd->invalide = realloc(gd->invalide, gd->capF);
+        memset(gd->invalide + gd->numF, 0, gd->capF - gd->numF);
+    }
+    int id = gd->numF++;
+    gd->faces[id] = nf;
+    gd->vivante[id] = 1;
+    gd->distance[id] = -1;
+    gd->numVivantes++;
+    for (int k = 0; k < 3; k++)
+        lierArete(gd, cleFace(nf, k), id);
+    return id;
+}
+
+
+/**
+ * @brief   Construit le graphe dynamique et les distances à partir des faces du maillage.
+ *          La source est celle de writeObjFile (max(graine - 1, 0)) : sans édition, les
+ *          distances sont les mêmes que celles du parcours habituel.
+ * @param   f       Tableau des faces
+ * @param   numF    Nombre de faces
+ * @return  Graphe dynamique (à libérer avec libererGrapheDynamique)
+ */
+GrapheDynamique *creerGrapheDynamique(Face *f, int numF)
+{
+    GrapheDynamique *gd = calloc(1, sizeof(GrapheDynamique));
+    gd->bits = 4;
+    while (((size_t)1 << gd->bits) < (size_t)numF * 3)   //Environ 1,5 arête par face
+        gd->bits++;
+    gd->cles = calloc((size_t)1 << gd->bits, sizeof(uint64_t));
+    gd->tete = malloc(sizeof(int) * ((size_t)1 << gd->bits));
+    gd->queue = malloc(sizeof(int) * ((size_t)1 << gd->bits));
+    gd->capNoeuds = max(16, numF * 3);
+    gd->noeudFace = malloc(sizeof(int) * gd->capNoeuds);
+    gd->noeudSuivant = malloc(sizeof(int) * gd->capNoeuds);
+    gd->noeudLibre = -1;
+    gd->capVoisins = 16;
+    gd->voisins = malloc(sizeof(int) * gd->capVoisins);
+    gd->capTas = 64;
+    gd->tas = malloc(sizeof(uint64_t) * gd->capTas);
+    gd->graine = 1;
+    gd->capF = max(16, numF);
+    gd->faces = malloc(sizeof(Face) * gd->capF);
+    gd->vivante = malloc(gd->capF);
+    gd->distance = malloc(sizeof(int) * gd->capF);
+    gd->invalide = calloc(gd->capF, 1);
+
+    for (int i = 0; i < numF; i++)
+        insererFace(gd, f[i]);
+    gd->source = numF > 0 ? max(gd->graine - 1, 0) : -1;
+    distancesCompletes(gd);
+    gd->reparees = 0;
+    return gd;
+}
+
+
+/**
+ * @brief   Ajoute une face : ses arêtes sont appariées en O(1) attendu, puis les distances
+ *          qui baissent sont propagées depuis la nouvelle face.
+ * @return  Indice de la nouvelle face
+ */
+int ajouterFace(GrapheDynamique *gd, Face nf)
+{
+    int id = insererFace(gd, nf);
+    if (gd->source < 0 || !gd->vivante[gd->source])
+    {
+        gd->source = id;
+        distancesCompletes(gd);
+        return id;
+    }
+    int n = voisinsDynamiques(gd, id);
+    for (int k = 0; k < n; k++)
+    {
+        int d = gd->distance[gd->voisins[k]];
+        if (d != -1 && (gd->distance[id] == -1 || d + 1 < gd->distance[id]))
+            gd->distance[id] = d + 1;
+    }
+    if (gd->distance[id] != -1)
+    {
+        gd->reparees++;
+        tasDynPousser(gd, gd->distance[id], id);
+        propagerDistances(gd);
+    }
+    return id;
+}
+
+
+/**
+ * @brief   Retire une face et répare les distances de la zone touchée.
+ *
+ * Une face garde sa distance tant qu'un voisin est à la distance juste inférieure. Les faces
+ * qui perdent ce soutien sont invalidées par distance croissante (elles peuvent entraîner
+ * leurs successeurs), puis reçoivent la meilleure distance offerte par leurs voisins valides
+ * et la propagent. Si la source est retirée, la plus petite face vivante la remplace.
+ *
+ * @return  1 si la face a été retirée, 0 si elle n'existe pas
+ */
+int retirerFace(GrapheDynamique *gd, int id)
+{
+    if (id < 0 || id >= gd->numF || !gd->vivante[id])
+        return 0;
+
+    int n = voisinsDynamiques(gd, id);
+    int *candidats = malloc(sizeof(int) * max(n, 1));
+    memcpy(candidats, gd->voisins, sizeof(int) * n);
+
+    uint64_t nouvelles[3];    //Arêtes dont la première face change : nouvelles arêtes duales
+    int numNouvelles = 0;
+    for (int k = 0; k < 3; k++)
+    {
+        uint64_t cle = cleFace(gd->faces[id], k);
+        if (delierArete(gd, cle, id) != -1)
+            nouvelles[numNouvelles++] = cle;
+    }
+    gd->vivante[id] = 0;
+    gd->numVivantes--;
+    gd->distance[id] = -1;
+
+    if (id == gd->source)
+    {
+        gd->source = -1;
+        for (int i = 0; i < gd->numF && gd->source == -1; i++)
+            if (gd->vivante[i])
+                gd->source = i;
+        distancesCompletes(gd);
+        free(candidats);
+        return 1;
+    }
+
+    //Invalidation par distance croissante, l'ancienne distance sert de priorité
+    char *invalide = gd->invalide;
+    int numInvalides = 0;
+    for (int k = 0; k < n; k++)
+        if (gd->distance[candidats[k]] > 0)
+            tasDynPousser(gd, gd->distance[candidats[k]], candidats[k]);
+    while (gd->tailleTas > 0)
+    {
+        uint64_t x = tasDynExtraire(gd);
+        int d = (int)(x >> 32), u = (int)(uint32_t)x;
+        if (invalide[u])
+            continue;
+        int m = voisinsDynamiques(gd, u), soutenue = 0;
+        for (int k = 0; k < m && !soutenue; k++)
+            soutenue = !invalide[gd->voisins[k]] && gd->distance[gd->voisins[k]] == d - 1;
+        if (soutenue)
+            continue;
+        invalide[u] = 1;
+        if (numInvalides == gd->capInvalides)
+        {
+            gd->capInvalides = max(16, gd->capInvalides * 2);
+            gd->invalides = realloc(gd->invalides, sizeof(int) * gd->capInvalides);
+        }
+        gd->invalides[numInvalides++] = u;
+        for (int k = 0; k < m; k++)
+            if (!invalide[gd->voisins[k]] && gd->distance[gd->voisins[k]] == d + 1)
+                tasDynPousser(gd, d + 1, gd->voisins[k]);
+    }
+
+    int *invalides = gd->invalides;
+    for (int i = 0; i < numInvalides; i++)
+        gd->distance[invalides[i]] = -1;
+    for (int i = 0; i < numInvalides; i++)    //Meilleure distance offerte par la frontière valide
+    {
+        int u = invalides[i];
+        int m = voisinsDynamiques(gd, u);
+        for (int k = 0; k < m; k++)
+        {
+            int w = gd->voisins[k];
+            if (!invalide[w] && gd->distance[w] != -1 && (gd->distance[u] == -1 || gd->distance[w] + 1 < gd->distance[u]))
+                gd->distance[u] = gd->distance[w] + 1;
+        }
+        gd->reparees++;
+        if (gd->distance[u] != -1)
+            tasDynPousser(gd, gd->distance[u], u);
+    }
+    for (int i = 0; i < numNouvelles; i++)    //Les nouvelles arêtes duales peuvent raccourcir des chemins, dans les deux sens
+    {
+        size_t h = chercherCle(gd, nouvelles[i]);
+        for (int x = gd->tete[h]; x != -1; x = gd->noeudSuivant[x])
+            if (gd->distance[gd->noeudFace[x]] != -1)
+                tasDynPousser(gd, gd->distance[gd->noeudFace[x]], gd->noeudFace[x]);
+    }
+    propagerDistances(gd);
+
+    for (int i = 0; i < numInvalides; i++)    //Seules les marques posées sont effacées
+        invalide[invalides[i]] = 0;
+    free(candidats);
+    return 1;
+}
+
+
+/**
+ * @brief   Graphe dual CSR des faces vivantes, renumérotées dans l'ordre
+ * @param   gd      Graphe dynamique
+ * @param   renum   Reçoit le nouvel indice de chaque face (-1 si retirée), à libérer
+ * @return  Graphe CSR (à libérer avec libererCSR)
+ */
+DualCSR *exporterDynamique(GrapheDynamique *gd, int **renum)
+{
+    int *r = malloc(sizeof(int) * max(gd->numF, 1));
+    int numVivantes = 0;
+    for (int i = 0; i < gd->numF; i++)
+        r[i] = gd->vivante[i] ? numVivantes++ : -1;
+
+    DualCSR *g = malloc(sizeof(DualCSR));
+    g->numF = numVivantes;
+    g->debut = calloc(numVivantes + 1, sizeof(int));
+    g->graine = gd->source >= 0 ? r[gd->source] + 1 : 1;
+    size_t capacite = (size_t)1 << gd->bits;
+
+    for (int passe = 0; passe < 2; passe++)   //Degrés, puis remplissage
+    {
+        int *pos = NULL;
+        if (passe == 1)
+        {
+            for (int i = 0; i < numVivantes; i++)
+                g->debut[i + 1] += g->debut[i];
+            g->voisins = malloc(sizeof(int) * 2 * max(g->numAretes, 1));
+            pos = malloc(sizeof(int) * max(numVivantes, 1));
+            memcpy(pos, g->debut, sizeof(int) * numVivantes);
+        }
+        g->numAretes = 0;
+        for (size_t h = 0; h < capacite; h++)
+        {
+            if (gd->cles[h] == 0)
+                continue;
+            int premiere = r[gd->noeudFace[gd->tete[h]]];
+            for (int x = gd->noeudSuivant[gd->tete[h]]; x != -1; x = gd->noeudSuivant[x])
+            {
+                int autre = r[gd->noeudFace[x]];
+                if (autre == premiere)
+                    continue;
+                if (passe == 0)
+                {
+                    g->debut[premiere + 1]++;
+                    g->debut[autre + 1]++;
+                }
+                else
+                {
+                    g->voisins[pos[premiere]++] = autre;
+                    g->voisins[pos[autre]++] = premiere;
+                }
+                g->numAretes++;
+            }
+        }
+        free(pos);
+    }
+    *renum = r;
+    return g;
+}
+
+
+void libererGrapheDynamique(GrapheDynamique *gd)
+{
+    free(gd->faces);
+    free(gd->vivante);
+    free(gd->cles);
+    free(gd->tete);
+    free(gd->queue);
+    free(gd->noeudFace);
+    free(gd->noeudSuivant);
+    free(gd->distance);
+    free(gd->voisins);
+    free(gd->tas);
+    free(gd->invalide);
+    free(gd->invalides);
+    free(gd);
+}
+
+
+/**
+ * @brief   Écrit un fichier .obj avec des couleurs basées sur des distances déjà calculées
+ *
+ * Chaque arête duale est écrite une fois, depuis sa plus petite face.
+ *
+ * @param   centoides       Tableau des centroïdes
+ * @param   numface         Nombre de faces
+ * @param   filename        Nom du fichier de sortie (par exemple bunny_colored.obj)
+ * @param   g               Graphe dual
+ * @param   distance        Distance de chaque face (nombre de sauts ou géodésique)
+ * @param   maxDistance     Distance maximale (unité du dégradé)
+ * @return  1 si le fichier a été écrit, 0 sinon
+ */
+int ecrireObjDistances(Centoide *centoides, int numface, const char *filename, DualCSR *g, const float *distance,
+                       float maxDistance)
+{
+    Tampon *file = ouvrirTampon(filename, ecritureAsynchrone);
+    if (file == NULL)
+        return 0;
+
+    int numCentoides = numface;
+    float parametre = 1.0 / maxDistance;    //Calculer l'unité
+
+    for (int i = 0; i < numCentoides; i++)   //Rouge 1 0 0  vert 0 1 0
+    {
+        int j = reordre ? reordre->rangFaces[i] : i;    //Sortie dans la numérotation d'origine
+        //Même texte que fprintf(file, "v %f %f %f %f %f %f\n", ...), avec les mêmes types
+        tamponTexte(file, "v ");
+        tamponFloat(file, centoides[j].centre.a);
+        tamponTexte(file, " ");
+        tamponFloat(file, centoides[j].centre.b);
+        tamponTexte(file, " ");
+        tamponFloat(file, centoides[j].centre.c);
+        tamponTexte(file, " ");
+        tamponFloat(file, (1.0 - distance[j]) * parametre);    //Mêmes types qu'avec les distances entières
+        tamponTexte(file, " ");
+        tamponFloat(file, distance[j] * parametre);
+        tamponTexte(file, " 0.000000\n");
+    }
+
+    for (int i = 0; i < numface; i++)
+    {
+        int j = reordre ? reordre->rangFaces[i] : i;
+        const int *voisins = voisinsCSR(g, j);
+        for (int k = 0; k < degreCSR(g, j); k++)
+        {
+            int o = reordre ? reordre->origineFaces[voisins[k]] : voisins[k];
+            if (i < o)
+            {
+                tamponTexte(file, "l ");
+                tamponInt(file, i + 1);
+                tamponTexte(file, " ");
+                tamponInt(file, o + 1);
+                tamponTexte(file, "\n");
+            }
+        }
+    }
+
+    return fermerTampon(file);
+}
+
+
+// formats binaires
+
+#define FORMAT_OBJ 0
+#define FORMAT_PLY 1
+#define FORMAT_GDC 2
+
+int formatSortie = FORMAT_OBJ;     //Option --format
+
+#define GDC_MAGIE "GDC1\r\n\032\n"   //Détecte les transferts en mode texte
+#define PLY_SOMMET 19                //Octets par sommet PLY : x y z, rouge vert bleu, distance
+
+/**
+ * @brief   En-tête du format natif compressé (.gdc). Suivent : les centres (3 float par face),
+ *          les distances (uint16, 0xFFFF pour -1, ou float), puis pour chaque face le nombre de
+ *          ses lignes l en varint et les voisins correspondants, en écarts zigzag + varint
+ *          depuis la face ou le voisin précédent. Tout est en petit-boutiste.
+ */
+typedef struct enteteGDC
+{
+    char magie[8];
+    int32_t numF;
+    int32_t numAretes;      //Lignes l
+    int32_t distances16;    //1 : distances entières sur 16 bits, 0 : float
+    float maxDistance;
+} EnteteGDC;
+
+
+/**
+ * @brief   Voisins d'une face écrits comme lignes l (numérotation de sortie), dans l'ordre du CSR
+ * @param   i       Face, numérotation d'origine
+ * @param   sortie  Reçoit les voisins d'indice supérieur à i (au moins le degré de la face)
+ * @return  Nombre de voisins
+ */
+static int voisinsSortie(DualCSR *g, int i, int *sortie)
+{
+    int j = reordre ? reordre->rangFaces[i] : i;
+    const int *voisins = voisinsCSR(g, j);
+    int n = 0;
+    for (int k = 0; k < degreCSR(g, j); k++)
+    {
+        int o = reordre ? reordre->origineFaces[voisins[k]] : voisins[k];
+        if (i < o)
+            sortie[n++] = o;
+    }
+    return n;
+}
+
+static int degreMaxCSR(DualCSR *g)
+{
+    int d = 0;
+    for (int f = 0; f < g->numF; f++)
+        d = max(d, degreCSR(g, f));
+    return d;
+}
+
+static unsigned char octetCouleur(double x)
+{
+    return x <= 0 ? 0 : x >= 1 ? 255 : (unsigned char)(x * 255 + 0.5);
+}
+
+
+/**
+ * @brief   Écrit le graphe dual en PLY binaire : un sommet par face (centre, couleur du dégradé
+ *          de l'OBJ ramenée sur [0, 255], distance en float) et un élément edge par ligne l.
+ *          La distance et le commentaire distance_max permettent de retrouver l'OBJ exact.
+ */
+int ecrirePLY(Centoide *centoides, int numface, const char *filename, DualCSR *g, const float *distance,
+              float maxDistance)
+{
+    Tampon *t = ouvrirTampon(filename, ecritureAsynchrone);
+    if (t == NULL)
+        return 0;
+
+    int degreMax = degreMaxCSR(g);
+    int *voisins = malloc(sizeof(int) * max(degreMax, 1));
+    int numAretes = 0;
+    for (int i = 0; i < numface; i++)
+        numAretes += voisinsSortie(g, i, voisins);
+
+    char entete[512];
+    snprintf(entete, sizeof(entete),
+             "ply\nformat binary_little_endian 1.0\ncomment distance_max %.9g\n"
+             "element vertex %d\nproperty float x\nproperty float y\nproperty float z\n"
+             "property uchar red\nproperty uchar green\nproperty uchar blue\nproperty float distance\n"
+             "element edge %d\nproperty int vertex1\nproperty int vertex2\nend_header\n",
+             maxDistance, numface, numAretes);
+    tamponTexte(t, entete);
+
+    float parametre = 1.0 / maxDistance;
+    for (int i = 0; i < numface; i++)
+    {
+        int j = reordre ? reordre->rangFaces[i] : i;
+        unsigned char sommet[PLY_SOMMET];
+        memcpy(sommet, &centoides[j].centre, 3 * sizeof(float));
+        sommet[12] = octetCouleur((1.0 - distance[j]) * parametre);
+        sommet[13] = octetCouleur(distance[j] * parametre);
+        sommet[14] = 0;
+        memcpy(sommet + 15, &distance[j], sizeof(float));
+        tamponOctets(t, sommet, PLY_SOMMET);
+    }
+    for (int i = 0; i < numface; i++)
+    {
+        int n = voisinsSortie(g, i, voisins);
+        for (int k = 0; k < n; k++)
+        {
+            int32_t arete[2] = {i, voisins[k]};
+            tamponOctets(t, arete, sizeof(arete));
+        }
+    }
+
+    free(voisins);
+    return fermerTampon(t);
+}
+
+
+/**
+ * @brief   Écrit le graphe dual au format natif compressé (voir EnteteGDC)
+ */
+int ecrireGDC(Centoide *centoides, int numface, const char *filename, DualCSR *g, const float *distance,
+              float maxDistance)
+{
+    Tampon *t = ouvrirTampon(filename, ecritureAsynchrone);
+    if (t == NULL)
+        return 0;
+
+    int degreMax = degreMaxCSR(g);
+    int *voisins = malloc(sizeof(int) * max(degreMax, 1));
+    EnteteGDC e;
+    memcpy(e.magie, GDC_MAGIE, sizeof(e.magie));
+    e.numF = numface;
+    e.numAretes = 0;
+    e.distances16 = 1;
+    e.maxDistance = maxDistance;
+    for (int i = 0; i < numface; i++)
+    {
+        e.numAretes += voisinsSortie(g, i, voisins);
+        float d = distance[i];
+        if (d != (int)d || d < -1 || d > 65534)     //Distances géodésiques, ou plus de 65534 sauts
+            e.distances16 = 0;
+    }
+    tamponOctets(t, &e, sizeof(e));
+
+    for (int i = 0; i < numface; i++)
+        tamponOctets(t, &centoides[reordre ? reordre->rangFaces[i] : i].centre, 3 * sizeof(float));
+    for (int i = 0; i < numface; i++)
+    {
+        float d = distance[reordre ? reordre->rangFaces[i] : i];
+        if (e.distances16)
+        {
+            uint16_t x = d < 0 ? 0xFFFF : (uint16_t)d;
+            tamponOctets(t, &x, sizeof(x));
+        }
+        else
+            tamponOctets(t, &d, sizeof(d));
+    }
+    for (int i = 0; i < numface; i++)
+    {
+        int n = voisinsSortie(g, i, voisins);
+        tamponVarint(t, n);
+        int precedent = i;
+        for (int k = 0; k < n; k++)
+        {
+            int32_t ecart = voisins[k] - precedent;
+            tamponVarint(t, ((uint32_t)ecart << 1) ^ (uint32_t)(ecart >> 31));   //Zigzag : petits écarts négatifs compris
+            precedent = voisins[k];
+        }
+    }
+
+    free(voisins);
+    return fermerTampon(t);
+}
+
+
+/**
+ * @brief   Graphe dual à sens unique relu d'un fichier binaire : chaque ligne l n'apparaît que
+ *          chez sa plus petite face, ce qui suffit à ecrireObjDistances.
+ */
+static DualCSR *csrSortie(int numF, int numAretes)
+{
+    DualCSR *g = malloc(sizeof(DualCSR));
+    g->numF = numF;
+    g->numAretes = numAretes;
+    g->debut = calloc(numF + 1, sizeof(int));
+    g->voisins = malloc(sizeof(int) * max(numAretes, 1));
+    g->graine = 1;
+    return g;
+}
+
+static int lireVarint(const unsigned char **p, const unsigned char *fin, uint32_t *x)
+{
+    *x = 0;
+    for (int decalage = 0; decalage < 35 && *p < fin; decalage += 7)
+    {
+        unsigned char o = *(*p)++;
+        *x |= (uint32_t)(o & 0x7F) << decalage;
+        if (!(o & 0x80))
+            return 1;
+    }
+    return 0;
+}
+
+static int lireGDC(const char *data, size_t taille, Centoide **c, float **distance, float *maxDistance, DualCSR **g)
+{
+    EnteteGDC e;
+    if (taille < sizeof(e))
+        return 0;
+    memcpy(&e, data, sizeof(e));
+    size_t fixe = sizeof(e) + (size_t)e.numF * (3 * sizeof(float) + (e.distances16 ? 2 : 4));
+    if (e.numF < 0 || e.numAretes < 0 || taille < fixe)
+        return 0;
+
+    *maxDistance = e.maxDistance;
+    *c = malloc(sizeof(Centoide) * max(e.numF, 1));
+    *distance = malloc(sizeof(float) * max(e.numF, 1));
+    const char *p = data + sizeof(e);
+    for (int i = 0; i < e.numF; i++, p += 3 * sizeof(float))
+        memcpy(&(*c)[i].centre, p, 3 * sizeof(float));
+    for (int i = 0; i < e.numF; i++)
+    {
+        if (e.distances16)
+        {
+            uint16_t x;
+            memcpy(&x, p, sizeof(x));
+            (*distance)[i] = x == 0xFFFF ? -1 : x;
+            p += sizeof(x);
+        }
+        else
+        {
+            memcpy(&(*distance)[i], p, sizeof(float));
+            p += sizeof(float);
+        }
+    }
+
+    *g = csrSortie(e.numF, e.numAretes);
+    const unsigned char *q = (const unsigned char *)p, *fin = (const unsigned char *)data + taille;
+    int pos = 0;
+    for (int i = 0; i < e.numF; i++)
+    {
+        uint32_t n, zz;
+        if (!lireVarint(&q, fin, &n) || n > (uint32_t)(e.numAretes - pos))
+            return 0;
+        int precedent = i;
+        for (uint32_t k = 0; k < n; k++)
+        {
+            if (!lireVarint(&q, fin, &zz))
+                return 0;
+            precedent += (int32_t)((zz >> 1) ^ (0u - (zz & 1)));
+            if (precedent <= i || precedent >= e.numF)
+                return 0;
+            (*g)->voisins[pos++] = precedent;
+        }
+        (*g)->debut[i + 1] = pos;
+    }
+    return pos == e.numAretes && q == fin;
+}
+
+static int lirePLY(const char *data, size_t taille, Centoide **c, float **distance, float *maxDistance, DualCSR **g)
+{
+    const char *finEntete = memmem(data, taille, "end_header\n", 11);
+    const char *commentaire = memmem(data, taille, "comment distance_max ", 21);
+    const char *sommets = memmem(data, taille, "element vertex ", 15);
+    const char *aretes = memmem(data, taille, "element edge ", 13);
+    if (finEntete == NULL || commentaire == NULL || sommets == NULL || aretes == NULL || commentaire > finEntete ||
+        sommets > finEntete || aretes > finEntete || strncmp(data, "ply\nformat binary_little_endian 1.0\n", 36) != 0)
+        return 0;
+
+    int numF = atoi(sommets + 15), numAretes = atoi(aretes + 13);
+    *maxDistance = strtof(commentaire + 21, NULL);
+    const char *p = finEntete + 11;
+    if (numF < 0 || numAretes < 0 ||
+        (size_t)(data + taille - p) != (size_t)numF * PLY_SOMMET + (size_t)numAretes * 2 * sizeof(int32_t))
+        return 0;
+
+    *c = malloc(sizeof(Centoide) * max(numF, 1));
+    *distance = malloc(sizeof(float) * max(numF, 1));
+    for (int i = 0; i < numF; i++, p += PLY_SOMMET)
+    {
+        memcpy(&(*c)[i].centre, p, 3 * sizeof(float));
+        memcpy(&(*distance)[i], p + 15, sizeof(float));
+    }
+
+    *g = csrSortie(numF, numAretes);
+    int precedente = 0;
+    for (int k = 0; k < numAretes; k++, p += 2 * sizeof(int32_t))
+    {
+        int32_t arete[2];
+        memcpy(arete, p, sizeof(arete));
+        if (arete[0] < precedente || arete[0] >= arete[1] || arete[1] >= numF)
+            return 0;   //Arêtes rangées par première face, comme les écrit ecrirePLY
+        for (int f = precedente; f < arete[0]; f++)
+            (*g)->debut[f + 1] = k;
+        precedente = arete[0];
+        (*g)->voisins[k] = arete[1];
+    }
+    for (int f = precedente; f < numF; f++)
+        (*g)->debut[f + 1] = numAretes;
+    return 1;
+}
+
+
+/**
+ * @brief   Reconvertit une sortie PLY ou GDC de ce programme en OBJ, au caractère près
+ *          (option --vers-obj)
+ * @return  1 si tout s'est bien passé, 0 sinon
+ */
+int convertirVersObj(const char *source, const char *fileDst)
+{
+    size_t taille;
+    const char *data = projeterFichier(source, &taille);
+    if (data == NULL)
+    {
+        printf("Impossible de lire %s\n", source);
+        return 0;
+    }
+
+    Centoide *c = NULL;
+    float *distance = NULL;
+    float maxDistance;
+    DualCSR *g = NULL;
+    int ok;
+    if (taille >= 8 && memcmp(data, GDC_MAGIE, 8) == 0)
+        ok = lireGDC(data, taille, &c, &distance, &maxDistance, &g);
+    else
+        ok = lirePLY(data, taille, &c, &distance, &maxDistance, &g);
+    munmap((void *)data, taille);
+
+    if (!ok)
+        printf("Fichier %s invalide (PLY binaire ou GDC attendu)\n", source);
+    else
+        ok = ecrireObjDistances(c, g->numF, fileDst, g, distance, maxDistance);
+    if (g != NULL)
+        libererCSR(g);
+    free(c);
+    free(distance);
+    return ok;
+}
+
+
+/**
+ * @brief   Écrit la sortie dans le format choisi (--format), sans rien afficher
+ * @return  1 si le fichier a été écrit, 0 sinon
+ */
+int ecrireFormat(Centoide *centoides, int numface, const char *filename, DualCSR *g, const float *distance,
+                 float maxDistance)
+{
+    if (formatSortie == FORMAT_PLY)
+        return ecrirePLY(centoides, numface, filename, g, distance, maxDistance);
+    if (formatSortie == FORMAT_GDC)
+        return ecrireGDC(centoides, numface, filename, g, distance, maxDistance);
+    return ecrireObjDistances(centoides, numface, filename, g, distance, maxDistance);
+}
+
+/**
+ * @brief   Écrit la sortie dans le format choisi (--format) et affiche la distance maximale
+ *          et l'unité du dégradé
+ */
+void ecrireSortie(Centoide *centoides, int numface, const char *filename, DualCSR *g, const float *distance,
+                  float maxDistance)
+{
+    int phase = debutPhase("ecriture");
+    printf("%.10g\n", maxDistance);
+    float parametre = 1.0 / maxDistance;    //Calculer l'unité
+    printf("%f\n", parametre);
+
+    if (!ecrireFormat(centoides, numface, filename, g, distance, maxDistance))
+        fprintf(stderr, "write\n");
+    finPhase(phase);
+}
+
+
+int geodesique = 0;     //Option --geodesique : distances pondérées par l'écart entre les centres
+int parComposantes = 0; //Option --composantes : un parcours par composante connexe
+
+/**
+ * @brief   Calcule les distances depuis la graine (sauts ou géodésiques) puis écrit le
+ *          fichier .obj coloré
+ *
+ * @param   centoides       Tableau des centroïdes
+ * @param   numface         Nombre de faces
+ * @param   filename        Nom du fichier de sortie (par exemple bunny_colored.obj)
+ * @param   g               Graphe dual
+ */
+void writeObjFile(Centoide *centoides, int numface, const char *filename, DualCSR *g)
+{
+    float *distance;
+    float maxDistance;
+    int phase = debutPhase("bfs");
+    if (geodesique)
+        distance = distancesGeodesiques(g, centoides, max(g->graine - 1, 0), &maxDistance);
+    else
+    {
+        int maxSauts;
+        CentoideC *cc;
+        if (bfsParallele)
+        {
+            NiveauBFS *stats;
+            int numNiveaux;
+            cc = createCentoideArrayParallele(g, numface, g->graine, &maxSauts, &stats, &numNiveaux);
+            if (bfsStats)
+                afficherStatsBFS(stats, numNiveaux);
+            free(stats);
+        }
+        else if (parComposantes)
+            cc = createCentoideArrayComposantes(g, numface, g->graine, &maxSauts);
+        else
+            cc = createCentoideArray(g, numface, g->graine, &maxSauts);     // crée centoide couleur
+        compteurNiveauxBFS += maxSauts + 1;
+        distance = allouer(sizeof(float) * max(numface, 1));
+        for (int i = 0; i < numface; i++)
+            distance[i] = cc[i].distance;
+        maxDistance = maxSauts;
+        free(cc);
+    }
+    finPhase(phase);
+    ecrireSortie(centoides, numface, filename, g, distance, maxDistance);
+    free(distance);
+}
+
+/**
+ * @brief   Applique un fichier d'éditions au maillage avec le graphe dual dynamique, puis
+ *          écrit le résultat comme writeObjFile (option --editions).
+ *
+ * Une ligne par édition : "+ v1 v2 v3" ajoute une face (sommets existants, indices à partir
+ * de 1), "- n" retire la face n (numérotation du maillage d'origine, les faces ajoutées
+ * prennent les numéros suivants). Les lignes vides et les commentaires # sont ignorés.
+ *
+ * @return  1 si tout s'est bien passé, 0 sinon
+ */
+int traiterEditions(const char *fichierEditions, Vertex *v, int numV, Face *f, int numF, const char *fileDst)
+{
+    FILE *in = fopen(fichierEditions, "r");
+    if (in == NULL)
+    {
+        printf("Impossible d'ouvrir le fichier d'éditions %s\n", fichierEditions);
+        return 0;
+    }
+
+    double debut = tempsMur();
+    GrapheDynamique *gd = creerGrapheDynamique(f, numF);
+    printf("Graphe dynamique : %d faces, %d arêtes en %f s\n", numF, gd->numCles, tempsMur() - debut);
+
+    char ligne[256];
+    int ajouts = 0, retraits = 0, numLigne = 0, ok = 1;
+    debut = tempsMur();
+    while (fgets(ligne, sizeof(ligne), in) != NULL)
+    {
+        numLigne++;
+        Face nf;
+        int n;
+        char op;
+        if (sscanf(ligne, " %c", &op) != 1 || op == '#')
+            continue;
+        if (op == '+' && sscanf(ligne, " + %d %d %d", &nf.v1, &nf.v2, &nf.v3) == 3 && nf.v1 >= 1 && nf.v1 <= numV &&
+            nf.v2 >= 1 && nf.v2 <= numV && nf.v3 >= 1 && nf.v3 <= numV)
+        {
+            ajouterFace(gd, nf);
+            ajouts++;
+        }
+        else if (op == '-' && sscanf(ligne, " - %d", &n) == 1 && retirerFace(gd, n - 1))
+            retraits++;
+        else
+        {
+            printf("Édition invalide ligne %d : %s", numLigne, ligne);
+            ok = 0;
+        }
+    }
+    fclose(in);
+    printf("Éditions : %d ajouts, %d retraits en %f s, %lld distances recalculées\n", ajouts, retraits,
+           tempsMur() - debut, gd->reparees);
+
+    int *renum;
+    DualCSR *g = exporterDynamique(gd, &renum);
+    Face *vivantes = malloc(sizeof(Face) * max(g->numF, 1));
+    float *distance = malloc(sizeof(float) * max(g->numF, 1));
+    int maxDistance = 0;
+    for (int i = 0; i < gd->numF; i++)
+    {
+        if (renum[i] == -1)
+            continue;
+        vivantes[renum[i]] = gd->faces[i];
+        distance[renum[i]] = gd->distance[i];
+        maxDistance = max(maxDistance, gd->distance[i]);
+    }
+    Centoide *c = calculateCentroids(v, numV, vivantes, g->numF);
+    ecrireSortie(c, g->numF, fileDst, g, distance, maxDistance);
+
+    free(c);
+    free(distance);
+    free(vivantes);
+    free(renum);
+    libererCSR(g);
+    libererGrapheDynamique(gd);
+    return ok;
+}
+
+
+/**
+ * @brief   Lit la liste des graines : "3,17,42" ou "@fichier" (entiers séparés par des
+ *          blancs ou des virgules). Les numéros de faces commencent à 1.
+ * @param   spec        Argument de --graines
+ * @param   numGraines  Reçoit le nombre de graines
+ * @return  Tableau des graines (à libérer), NULL en cas d'erreur
+ */
+int *lireGraines(const char *spec, int *numGraines)
+{
+    char *texte;
+    if (spec[0] == '@')
+    {
+        FILE *in = fopen(spec + 1, "r");
+        if (in == NULL)
+        {
+            printf("Impossible d'ouvrir le fichier de graines %s\n", spec + 1);
+            return NULL;
+        }
+        fseek(in, 0, SEEK_END);
+        long taille = ftell(in);
+        rewind(in);
+        texte = malloc(taille + 1);
+        texte[fread(texte, 1, taille, in)] = '\0';
+        fclose(in);
+    }
+    else
+        texte = strdup(spec);
+
+    int cap = 16, n = 0;
+    int *graines = malloc(sizeof(int) * cap);
+    for (char *jeton = strtok(texte, ", \t\r\n"); jeton != NULL; jeton = strtok(NULL, ", \t\r\n"))
+    {
+        char *fin;
+        long x = strtol(jeton, &fin, 10);
+        if (*fin != '\0' || x < 1 || x > 2147483647L)
+        {
+            printf("Graine invalide : %s\n", jeton);
+            free(graines);
+            free(texte);
+            return NULL;
+        }
+        if (n == cap)
+        {
+            cap *= 2;
+            graines = realloc(graines, sizeof(int) * cap);
+        }
+        graines[n++] = (int)x;
+    }
+    free(texte);
+    *numGraines = n;
+    return graines;
+}
+
+
+/**
+ * @brief   Calcule les distances depuis chaque graine en une seule série de parcours
+ *          multi-sources, puis écrit soit la matrice des distances (une ligne par graine :
+ *          numéro de la graine puis la distance de chaque face, -1 si inaccessible), soit un
+ *          fichier .obj coloré par graine (fileDst suivi de _graine<N>).
+ * @return  1 si tout s'est bien passé, 0 sinon
+ */
+int traiterGraines(Centoide *c, DualCSR *g, const int *graines, int numGraines, const char *fileDst,
+                   const char *fichierMatrice)
+{
+    int *sources = malloc(sizeof(int) * max(numGraines, 1));
+    for (int s = 0; s < numGraines; s++)
+    {
+        int numOrigine = rangSoudure ? numFacesSoudure : g->numF;
+        if (graines[s] > numOrigine)
+        {
+            printf("Graine %d hors du maillage (%d faces)\n", graines[s], numOrigine);
+            free(sources);
+            return 0;
+        }
+        int face = graines[s] - 1;      //Graines en numérotation d'origine : soudure puis réordonnancement
+        if (rangSoudure != NULL && (face = rangSoudure[face]) < 0)
+        {
+            printf("Graine %d retirée par --souder (face dégénérée)\n", graines[s]);
+            free(sources);
+            return 0;
+        }
+        sources[s] = reordre ? reordre->rangFaces[face] : face;
+    }
+
+    int phase = debutPhase("bfs multi");
+    double debut = tempsMur();
+    int *distances = distancesMultiSources(g, sources, numGraines);
+    printf("Parcours multi-sources : %d graines en %f s\n", numGraines, tempsMur() - debut);
+    finPhase(phase);
+
+    int ok = 1;
+    size_t n = g->numF;
+    if (fichierMatrice != NULL)
+    {
+        phase = debutPhase("ecriture");
+        Tampon *t = ouvrirTampon(fichierMatrice, ecritureAsynchrone);
+        if (t == NULL)
+            ok = 0;
+        else
+        {
+            for (int s = 0; s < numGraines; s++)
+            {
+                tamponInt(t, graines[s]);
+                for (size_t f = 0; f < n; f++)
+                {
+                    tamponTexte(t, " ");
+                    tamponInt(t, distances[s * n + (reordre ? (size_t)reordre->rangFaces[f] : f)]);
+                }
+                tamponTexte(t, "\n");
+            }
+            ok = fermerTampon(t);
+        }
+        if (!ok)
+            printf("Impossible d'écrire la matrice %s\n", fichierMatrice);
+        finPhase(phase);
+    }
+    else
+    {
+        size_t l = strlen(fileDst);
+        const char *point = strrchr(fileDst, '.');     //_graine<N> avant l'extension, quel que soit le format
+        size_t base = (point != NULL && strchr(point, '/') == NULL) ? (size_t)(point - fileDst) : l;
+        char *nom = malloc(l + 32);
+        float *distance = allouer(sizeof(float) * max(n, 1));
+        for (int s = 0; s < numGraines; s++)
+        {
+            int maxDistance = 0;
+            for (size_t f = 0; f < n; f++)
+            {
+                distance[f] = distances[s * n + f];
+                maxDistance = max(maxDistance, distances[s * n + f]);
+            }
+            snprintf(nom, l + 32, "%.*s_graine%d%s", (int)base, fileDst, graines[s], fileDst + base);
+            ecrireSortie(c, n, nom, g, distance, maxDistance);
+        }
+        free(distance);
+        free(nom);
+    }
+
+    free(distances);
+    free(sources);
+    return ok;
+}
+
+
+/*
+int facevoisin(Centoide c1, Centoide c2, Face *face)
+{
+    int tmp = 0;
+
+    Face f1 = face[c1.faceAssocie];
+    Face f2 = face[c2.faceAssocie];
+
+    if (f1.v1 == f2.v1 || f1.v1 == f2.v2 || f1.v1 == f2.v3)
+        tmp++;
+    if (f1.v2 == f2.v1 || f1.v2 == f2.v2 || f1.v2 == f2.v3)
+        tmp++;
+    if (f1.v3 == f2.v1 || f1.v3 == f2.v2 || f1.v3 == f2.v3)
+        tmp++;
+
+    return (tmp == 2) ? 1 : 0;
+}
+
+Arete *selectSort(Centoide *c, Face *face, int numf, int numv, int *numA)
+{
+    int nbDeAreM = numf + numv;
+    Arete *a = malloc(sizeof(Arete) * nbDeAreM);
+    int tmp = 0;
+    int i, j;
     for (i = 0; i < numf; i++)
     {
-        for (j = i + 1; j < numf; j++)
-        {
-            if (facevoisin(c[i], c[j], face))
-            {
-                a[tmp].sommet1 = c[i];
-                a[tmp].sommet2 = c[j];
-                tmp++;
-            }
-        }
+        for (j = i + 1; j < numf; j++)
+        {
+            if (facevoisin(c[i], c[j], face))
+            {
+                a[tmp].sommet1 = c[i];
+                a[tmp].sommet2 = c[j];
+                tmp++;
+            }
+        }
+    }
+    a = realloc(a, sizeof(Arete) * tmp);
+    *numA = tmp;
+    return a;
+}
+
+Vertex *AretetoV(Arete *a, int numA)
+{
+    int numV = numA * 2;
+    Vertex *v = malloc(sizeof(Vertex) * numV);
+    int i = 0;
+    int j = 0;
+    while (i < numV)
+    {
+        v[i] = a[j].sommet1.centre;
+        i++;
+        v[i] = a[j].sommet2.centre;
+        i++;
+        j++;
+    }
+    return v;
+}
+
+Face *AretetoF(Arete *a, int numA)
+{
+    Face *f = malloc(sizeof(Face) * numA);
+    for (int i = 0; i < numA; i++)
+    {
+        f[i].v1 = i * 2 + 1;
+        f[i].v2 = i * 2 + 1;
+        f[i].v3 = i * 2 + 2;
+    }
+    return f;
+} */
+
+Moteur moteurs[] = {
+    {"selection", triSelection, 1},
+    {"tas", triTas, 0},
+    {"avl", triAVL, 0},
+    {"hash", triHash, 0},
+    {"radix", triRadix, 0},
+    {"barbre", triBArbre, 0},
+    {"parallele", triParallele, 0},
+    {"groupes", triGroupes, 0},
+};
+
+int numMoteurs = sizeof(moteurs) / sizeof(moteurs[0]);
+
+
+/**
+ * @brief   Cherche un moteur d'appariement des arêtes par son nom
+ * @param   nom     Nom du moteur (par exemple avl)
+ * @return  Le moteur, ou NULL s'il n'existe pas
+ */
+Moteur *chercherMoteur(const char *nom)
+{
+    for (int i = 0; i < numMoteurs; i++)
+    {
+        if (strcmp(moteurs[i].nom, nom) == 0)
+            return &moteurs[i];
+    }
+    return NULL;
+}
+
+
+// traitement par lots
+
+/**
+ * @brief   Une ligne du manifeste de --lot et son résultat
+ */
+typedef struct travailLot
+{
+    char *entree, *sortie;
+    int ligne;              //Ligne du manifeste
+    off_t taille;           //Taille du fichier d'entrée (ordre de passage)
+    int numF;
+    double lecture, calcul, ecriture;   //Temps muraux (s)
+    int travailleur;
+    const char *erreur;     //NULL si le travail a réussi
+} TravailLot;
+
+/**
+ * @brief   Tableaux d'un travailleur, gardés d'un maillage à l'autre et agrandis seulement
+ *          quand un maillage plus gros arrive
+ */
+typedef struct espaceLot
+{
+    Vertex *v;
+    int capV;
+    Face *f;
+    int capF;
+    SommetsSoA soa;
+    int capSoA;
+    Centoide *c;
+    Arete *a;
+    int *distanceBFS, *file, *pos;
+    float *distance;
+    int capFaces;           //Capacité de c, a (x 3), distanceBFS, file, pos, distance
+    DualCSR g;
+    int capDebut, capVoisins;
+    PairesD paires;
+    int agrandissements;    //Nombre de fois où les tableaux par face ont dû grandir
+} EspaceLot;
+
+typedef struct contexteLot
+{
+    TravailLot *travaux;
+    int *ordre;             //Travaux du plus gros au plus petit
+    int numTravaux;
+    int prochain;           //Compteur atomique
+    Moteur *moteur;
+    pthread_mutex_t verrou; //Affichage de l'avancement
+    int faits;
+} ContexteLot;
+
+typedef struct threadLot
+{
+    ContexteLot *ctx;
+    int id;
+    EspaceLot espace;
+} ThreadLot;
+
+
+/**
+ * @brief   Traite un maillage avec les tableaux du travailleur : lecture séquentielle (le
+ *          parallélisme vient des autres travailleurs), passe sur les faces, appariement,
+ *          CSR, distances, écriture au format choisi
+ * @return  NULL si tout s'est bien passé, sinon la cause de l'échec
+ */
+static const char *traiterTravail(TravailLot *t, EspaceLot *e, Moteur *moteur)
+{
+    double debut = tempsMur();
+    size_t taille;
+    const char *data = projeterFichier(t->entree, &taille);
+    if (data == NULL)
+        return "lecture impossible";
+    int numV, numF;
+    const char *erreur = lireObjDans(data, taille, &e->v, &e->capV, &e->f, &e->capF, &numV, &numF);
+    munmap((void *)data, taille);
+    if (erreur != NULL)
+        return erreur;
+    t->numF = numF;
+    t->lecture = tempsMur() - debut;
+    if (numF == 0)
+        return "aucune face";
+
+    debut = tempsMur();
+    if (numF > e->capFaces)
+    {
+        e->capFaces = numF;
+        e->c = realloc(e->c, sizeof(Centoide) * numF);
+        e->a = realloc(e->a, sizeof(Arete) * 3 * numF);
+        e->distanceBFS = realloc(e->distanceBFS, sizeof(int) * numF);
+        e->file = realloc(e->file, sizeof(int) * numF);
+        e->pos = realloc(e->pos, sizeof(int) * numF);
+        e->distance = realloc(e->distance, sizeof(float) * numF);
+        e->g.debut = realloc(e->g.debut, sizeof(int) * (numF + 1));
+        e->agrandissements++;
+    }
+    remplirSoA(&e->soa, &e->capSoA, e->v, numV);
+    choisirNoyauFaces(NULL)(&e->soa, e->f, 0, numF, e->c, e->a);
+
+    reserverPaires(&e->paires, 3 * numF);    //Le tableau reste d'un travail à l'autre
+    moteur->tri(e->a, 3 * numF, &e->paires);
+    remplirCSR(&e->g, &e->paires, numF, &e->capVoisins, e->pos);
+
+    float maxDistance;
+    int source = max(e->g.graine - 1, 0);
+    if (geodesique)
+    {
+        float *d = distancesGeodesiques(&e->g, e->c, source, &maxDistance);
+        memcpy(e->distance, d, sizeof(float) * numF);
+        free(d);
+    }
+    else
+    {
+        maxDistance = bfsSource(&e->g, source, e->distanceBFS, e->file) - 1;
+        for (int i = 0; i < numF; i++)
+            e->distance[i] = e->distanceBFS[i];
+    }
+    t->calcul = tempsMur() - debut;
+
+    debut = tempsMur();
+    int ok = ecrireFormat(e->c, numF, t->sortie, &e->g, e->distance, maxDistance);
+    t->ecriture = tempsMur() - debut;
+    return ok ? NULL : "écriture impossible";
+}
+
+void *travailLot(void *arg)
+{
+    ThreadLot *t = arg;
+    ContexteLot *ctx = t->ctx;
+    travailleurLot = 1;
+    for (;;)
+    {
+        int k = __atomic_fetch_add(&ctx->prochain, 1, __ATOMIC_RELAXED);
+        if (k >= ctx->numTravaux)
+            break;
+        TravailLot *tr = &ctx->travaux[ctx->ordre[k]];
+        tr->travailleur = t->id;
+        tr->erreur = traiterTravail(tr, &t->espace, ctx->moteur);
+
+        pthread_mutex_lock(&ctx->verrou);
+        ctx->faits++;
+        printf("[%d/%d] %s : %s (%d faces, %.3f s)\n", ctx->faits, ctx->numTravaux, tr->entree,
+               tr->erreur ? tr->erreur : "ok", tr->numF, tr->lecture + tr->calcul + tr->ecriture);
+        fflush(stdout);
+        pthread_mutex_unlock(&ctx->verrou);
+    }
+    arenaLiberer(&arenaAVL);
+    return NULL;
+}
+
+
+/**
+ * @brief   Lit le manifeste de --lot : une paire "entree sortie" par ligne (chemins sans
+ *          espaces), lignes vides et commentaires # ignorés. Une ligne mal formée devient un
+ *          travail en échec, le lot continue.
+ * @return  Travaux (à libérer), NULL si le manifeste est illisible
+ */
+TravailLot *lireManifeste(const char *chemin, int *numTravaux)
+{
+    FILE *in = fopen(chemin, "r");
+    if (in == NULL)
+    {
+        printf("Impossible d'ouvrir le manifeste %s\n", chemin);
+        return NULL;
+    }
+    int cap = 64, n = 0, numLigne = 0;
+    TravailLot *travaux = malloc(sizeof(TravailLot) * cap);
+    char ligne[8192];
+    while (fgets(ligne, sizeof(ligne), in) != NULL)
+    {
+        numLigne++;
+        char entree[4096], sortie[4096], reste[2];
+        int lus = sscanf(ligne, "%4095s %4095s %1s", entree, sortie, reste);
+        if (lus <= 0 || entree[0] == '#')
+            continue;
+        if (n == cap)
+        {
+            cap *= 2;
+            travaux = realloc(travaux, sizeof(TravailLot) * cap);
+        }
+        TravailLot *t = &travaux[n++];
+        memset(t, 0, sizeof(TravailLot));
+        t->ligne = numLigne;
+        t->travailleur = -1;
+        t->entree = strdup(entree);
+        t->sortie = strdup(lus >= 2 ? sortie : "");
+        if (lus != 2)
+            t->erreur = "ligne du manifeste invalide";
+    }
+    fclose(in);
+    *numTravaux = n;
+    return travaux;
+}
+
+static int comparerTaille(const void *x, const void *y, void *travaux)
+{
+    const TravailLot *t = travaux;
+    off_t a = t[*(const int *)x].taille, b = t[*(const int *)y].taille;
+    return (a < b) - (a > b);   //Décroissant
+}
+
+
+/**
+ * @brief   Mode --lot : traite tous les maillages du manifeste sur nbThreads travailleurs.
+ *          Les plus gros fichiers partent en premier pour que le dernier travail fini soit
+ *          court. Un échec est noté dans le rapport sans arrêter le lot.
+ * @param   manifeste   Chemin du manifeste
+ * @param   moteur      Moteur d'appariement
+ * @param   rapport     Fichier CSV du rapport par travail, NULL pour aucun
+ * @return  1 si tous les travaux ont réussi, 0 sinon
+ */
+int traiterLot(const char *manifeste, Moteur *moteur, const char *rapport)
+{
+    ContexteLot ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.travaux = lireManifeste(manifeste, &ctx.numTravaux);
+    if (ctx.travaux == NULL)
+        return 0;
+    ctx.moteur = moteur;
+
+    //Seuls les travaux valides passent aux travailleurs
+    ctx.ordre = malloc(sizeof(int) * max(ctx.numTravaux, 1));
+    int numValides = 0;
+    for (int i = 0; i < ctx.numTravaux; i++)
+    {
+        TravailLot *t = &ctx.travaux[i];
+        if (t->erreur != NULL)
+            continue;
+        struct stat st;
+        if (stat(t->entree, &st) != 0)
+            t->erreur = "fichier introuvable";
+        else
+        {
+            t->taille = st.st_size;
+            ctx.ordre[numValides++] = i;
+        }
+    }
+    qsort_r(ctx.ordre, numValides, sizeof(int), comparerTaille, ctx.travaux);
+    int total = ctx.numTravaux;
+    ctx.numTravaux = numValides;
+
+    int nbT = max(1, min(nbThreads, numValides));
+    printf("Lot : %d travaux, %d travailleurs, moteur %s\n", total, nbT, moteur->nom);
+    pthread_mutex_init(&ctx.verrou, NULL);
+    pthread_t *threads = malloc(sizeof(pthread_t) * nbT);
+    ThreadLot *args = calloc(nbT, sizeof(ThreadLot));
+    double debut = tempsMur();
+    for (int t = 0; t < nbT; t++)
+    {
+        args[t].ctx = &ctx;
+        args[t].id = t;
+        pthread_create(&threads[t], NULL, travailLot, &args[t]);
+    }
+    for (int t = 0; t < nbT; t++)
+        pthread_join(threads[t], NULL);
+    double duree = tempsMur() - debut;
+    pthread_mutex_destroy(&ctx.verrou);
+
+    int echecs = 0;
+    for (int i = 0; i < total; i++)
+    {
+        TravailLot *t = &ctx.travaux[i];
+        if (t->erreur != NULL)
+        {
+            echecs++;
+            printf("Échec ligne %d (%s) : %s\n", t->ligne, t->entree, t->erreur);
+        }
+    }
+    int agrandissements = 0;
+    for (int t = 0; t < nbT; t++)
+        agrandissements += args[t].espace.agrandissements;
+    printf("Lot terminé en %f s : %d réussis, %d échecs, %d agrandissements de tableaux\n", duree, total - echecs,
+           echecs, agrandissements);
+
+    FILE *out = rapport ? fopen(rapport, "w") : NULL;
+    if (rapport != NULL && out == NULL)
+        printf("Impossible d'écrire le rapport %s\n", rapport);
+    if (out != NULL)
+    {
+        fprintf(out, "ligne,entree,sortie,octets,faces,travailleur,lecture_s,calcul_s,ecriture_s,statut\n");
+        for (int i = 0; i < total; i++)
+        {
+            TravailLot *t = &ctx.travaux[i];
+            fprintf(out, "%d,", t->ligne);
+            ecrireChampCSV(out, t->entree);
+            fputc(',', out);
+            ecrireChampCSV(out, t->sortie);
+            fprintf(out, ",%lld,%d,%d,%.6f,%.6f,%.6f,%s\n", (long long)t->taille, t->numF, t->travailleur, t->lecture,
+                    t->calcul, t->ecriture, t->erreur ? t->erreur : "ok");
+        }
+        fclose(out);
+        printf("Rapport écrit : %s\n", rapport);
+    }
+
+    for (int t = 0; t < nbT; t++)
+    {
+        EspaceLot *e = &args[t].espace;
+        free(e->v);
+        free(e->f);
+        libererSoA(&e->soa);
+        free(e->c);
+        free(e->a);
+        free(e->distanceBFS);
+        free(e->file);
+        free(e->pos);
+        free(e->distance);
+        free(e->g.debut);
+        free(e->g.voisins);
+        libererPaires(&e->paires);
+    }
+    for (int i = 0; i < total; i++)
+    {
+        free(ctx.travaux[i].entree);
+        free(ctx.travaux[i].sortie);
+    }
+    free(ctx.travaux);
+    free(ctx.ordre);
+    free(threads);
+    free(args);
+    return echecs == 0 && (rapport == NULL || out != NULL);
+}
+
+
+// banc d'essai
+
+typedef struct mesureBanc
+{
+    char maillage[256];
+    int numF, numA;
+    const char *moteur;
+    int nbMesures;
+    double mediane, p95, min;
+    int identique;          //Même ensemble d'arêtes duales que triHash
+    const char *statut;     //"ok", "different" ou "ignore"
+} MesureBanc;
+
+
+static int comparerDouble(const void *x, const void *y)
+{
+    double a = *(const double *)x, b = *(const double *)y;
+    return (a > b) - (a < b);
+}
+
+static int comparerPaire(const void *x, const void *y)
+{
+    const int *a = x, *b = y;
+    if (a[0] != b[0])
+        return (a[0] > b[0]) - (a[0] < b[0]);
+    return (a[1] > b[1]) - (a[1] < b[1]);
+}
+
+
+/**
+ * @brief   Ensemble trié des paires (min, max) : forme indépendante du moteur.
+ * @param   p       Arêtes duales
+ * @param   n       Nombre de paires
+ * @return  Tableau de 2n entiers (à libérer)
+ */
+int *pairesCanoniques(const PairesD *p, int *n)
+{
+    int *paires = malloc(sizeof(int) * 2 * max(p->num, 1));
+    for (int k = 0; k < p->num; k++)
+    {
+        paires[2 * k] = min(p->f[2 * k], p->f[2 * k + 1]);
+        paires[2 * k + 1] = max(p->f[2 * k], p->f[2 * k + 1]);
+    }
+    qsort(paires, p->num, 2 * sizeof(int), comparerPaire);
+    *n = p->num;
+    return paires;
+}
+
+
+/**
+ * @brief   Maillage synthétique : grille n x n de sommets, deux triangles par case, faces
+ *          mélangées (générateur fixe) pour ne pas avantager les moteurs sensibles à l'ordre.
+ */
+void maillageSynthetique(int n, Vertex **vertex, int *numV, Face **face, int *numF)
+{
+    *numV = n * n;
+    *numF = 2 * (n - 1) * (n - 1);
+    *vertex = malloc(sizeof(Vertex) * max(*numV, 1));
+    *face = malloc(sizeof(Face) * max(*numF, 1));
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = 0; j < n; j++)
+        {
+            (*vertex)[i * n + j].a = i;
+            (*vertex)[i * n + j].b = j;
+            (*vertex)[i * n + j].c = 0;
+        }
+    }
+    int k = 0;
+    for (int i = 0; i < n - 1; i++)
+    {
+        for (int j = 0; j < n - 1; j++)
+        {
+            int a = i * n + j + 1, b = a + 1, c = a + n, d = c + 1;
+            (*face)[k++] = (Face){a, b, c};
+            (*face)[k++] = (Face){b, d, c};
+        }
+    }
+    uint32_t graine = 12345;
+    for (int i = *numF - 1; i > 0; i--)    //Mélange de Fisher-Yates
+    {
+        graine = graine * 1664525u + 1013904223u;
+        int j = (int)(graine % (uint32_t)(i + 1));
+        Face t = (*face)[i];
+        (*face)[i] = (*face)[j];
+        (*face)[j] = t;
+    }
+}
+
+
+/**
+ * @brief   Mesure chaque moteur sur un maillage : échauffement, répétitions chronométrées
+ *          (horloge murale), médiane et 95e centile, et vérification des arêtes duales.
+ */
+static void mesurerMaillage(const char *nom, Vertex *v, int numF, Face *f, Moteur **choisis, int numChoisis,
+                            int repetitions, int echauffement, long long maxQuadratique, MesureBanc **mesures,
+                            int *numMesures, int *capMesures)
+{
+    int numA = numF * 3;
+    Arete *original = generalise(f, numF, v);
+    Arete *travail = malloc(sizeof(Arete) * max(numA, 1));    //Certains moteurs trient sur place
+    double *temps = malloc(sizeof(double) * max(repetitions, 1));
+
+    PairesD ad = {NULL, 0, 0};
+    reserverPaires(&ad, numA);
+    triHash(original, numA, &ad);
+    int numRef;
+    int *reference = pairesCanoniques(&ad, &numRef);
+
+    for (int e = 0; e < numChoisis; e++)
+    {
+        if (*numMesures == *capMesures)
+        {
+            *capMesures *= 2;
+            *mesures = realloc(*mesures, *capMesures * sizeof(MesureBanc));
+        }
+        MesureBanc *r = &(*mesures)[(*numMesures)++];
+        memset(r, 0, sizeof(*r));
+        snprintf(r->maillage, sizeof(r->maillage), "%s", nom);
+        r->numF = numF;
+        r->numA = numA;
+        r->moteur = choisis[e]->nom;
+
+        if (choisis[e]->quadratique && numA > maxQuadratique)
+        {
+            r->statut = "ignore";
+            printf("%-24s %-10s ignoré (%d arêtes > %lld)\n", nom, r->moteur, numA, maxQuadratique);
+            continue;
+        }
+
+        r->identique = 1;
+        for (int k = 0; k < echauffement + repetitions; k++)
+        {
+            memcpy(travail, original, sizeof(Arete) * numA);
+            reserverPaires(&ad, numA);
+            double debut = tempsMur();
+            choisis[e]->tri(travail, numA, &ad);
+            double duree = tempsMur() - debut;
+            if (k >= echauffement)
+                temps[k - echauffement] = duree;
+            if (k == 0)
+            {
+                int n;
+                int *paires = pairesCanoniques(&ad, &n);
+                r->identique = (n == numRef) && memcmp(paires, reference, sizeof(int) * 2 * n) == 0;
+                free(paires);
+            }
+        }
+
+        qsort(temps, repetitions, sizeof(double), comparerDouble);
+        r->nbMesures = repetitions;
+        r->min = temps[0];
+        r->mediane = (repetitions % 2) ? temps[repetitions / 2] : (temps[repetitions / 2 - 1] + temps[repetitions / 2]) / 2;
+        int i95 = (int)((repetitions * 95 + 99) / 100) - 1;    //Rang du 95e centile (plus proche rang)
+        r->p95 = temps[max(i95, 0)];
+        r->statut = r->identique ? "ok" : "different";
+        printf("%-24s %-10s médiane %10.6f s  p95 %10.6f s  min %10.6f s  %s\n", nom, r->moteur, r->mediane, r->p95,
+               r->min, r->identique ? "identique" : "DIFFÉRENT");
+    }
+
+    free(reference);
+    libererPaires(&ad);
+    free(original);
+    free(travail);
+    free(temps);
+}
+
+
+void usageBanc(const char *prog)
+{
+    printf("Utilisation: %s [-j N] --bench [options] [fichiers.obj...]\n", prog);
+    printf("  --repetitions N      mesures chronométrées par moteur (défaut 5)\n");
+    printf("  --echauffement N     exécutions non chronométrées avant les mesures (défaut 1)\n");
+    printf("  --synthetique N      ajoute une grille synthétique de N x N sommets (répétable)\n");
+    printf("  --moteurs a,b,...    moteurs à mesurer (défaut : tous)\n");
+    printf("  --max-quadratique N  ignore selection au-delà de N arêtes (défaut 60000)\n");
+    printf("  --json fichier       écrit les résultats en JSON\n");
+    printf("  --csv fichier        écrit les résultats en CSV\n");
+}
+
+
+/**
+ * @brief   Banc d'essai de tous les moteurs d'appariement (option --bench).
+ * @param   argc, argv  Arguments qui suivent --bench
+ * @param   prog        Nom du programme
+ * @return  0 si tous les moteurs mesurés donnent les mêmes arêtes duales, 1 sinon
+ */
+int banc(int argc, char **argv, const char *prog)
+{
+    int repetitions = 5, echauffement = 1;
+    long long maxQuadratique = 60000;
+    const char *json = NULL, *csv = NULL;
+    int *synthetiques = malloc(sizeof(int) * max(argc, 1));
+    int numSynthetiques = 0;
+    Moteur **choisis = malloc(sizeof(Moteur *) * numMoteurs);
+    int numChoisis = 0;
+    char **fichiers = malloc(sizeof(char *) * max(argc, 1));
+    int numFichiers = 0;
+    int erreur = 0;
+
+    for (int i = 0; i < argc && !erreur; i++)
+    {
+        int suivant = i + 1 < argc;
+        int valeur = suivant ? atoi(argv[i + 1]) : 0;    //max() est une macro : pas d'effet de bord dedans
+        if (strcmp(argv[i], "--repetitions") == 0 && suivant)
+        {
+            repetitions = max(1, valeur);
+            i++;
+        }
+        else if (strcmp(argv[i], "--echauffement") == 0 && suivant)
+        {
+            echauffement = max(0, valeur);
+            i++;
+        }
+        else if (strcmp(argv[i], "--synthetique") == 0 && suivant)
+        {
+            synthetiques[numSynthetiques++] = max(2, valeur);
+            i++;
+        }
+        else if (strcmp(argv[i], "--max-quadratique") == 0 && suivant)
+            maxQuadratique = atoll(argv[++i]);
+        else if (strcmp(argv[i], "--json") == 0 && suivant)
+            json = argv[++i];
+        else if (strcmp(argv[i], "--csv") == 0 && suivant)
+            csv = argv[++i];
+        else if (strcmp(argv[i], "--moteurs") == 0 && suivant)
+        {
+            char *liste = strdup(argv[++i]);
+            for (char *nom = strtok(liste, ","); nom != NULL; nom = strtok(NULL, ","))
+            {
+                Moteur *m = chercherMoteur(nom);
+                if (m == NULL)
+                {
+                    printf("Moteur inconnu: %s\n", nom);
+                    erreur = 1;
+                }
+                else if (numChoisis < numMoteurs)
+                    choisis[numChoisis++] = m;
+            }
+            free(liste);
+        }
+        else if (argv[i][0] == '-')
+            erreur = 1;
+        else
+            fichiers[numFichiers++] = argv[i];
+    }
+    if (erreur || numFichiers + numSynthetiques == 0)
+    {
+        usageBanc(prog);
+        free(synthetiques);
+        free(choisis);
+        free(fichiers);
+        return 1;
+    }
+    if (numChoisis == 0)
+    {
+        for (int e = 0; e < numMoteurs; e++)
+            choisis[numChoisis++] = &moteurs[e];
+    }
+
+    int capMesures = 16, numMesures = 0;
+    MesureBanc *mesures = malloc(capMesures * sizeof(MesureBanc));
+
+    for (int i = 0; i < numFichiers; i++)
+    {
+        Vertex *v;
+        Face *f;
+        int numV, numF;
+        if (!readObjMmap(fichiers[i], &v, &numV, &f, &numF))
+        {
+            erreur = 1;
+            continue;
+        }
+        mesurerMaillage(fichiers[i], v, numF, f, choisis, numChoisis, repetitions, echauffement, maxQuadratique,
+                        &mesures, &numMesures, &capMesures);
+        free(v);
+        free(f);
+    }
+    for (int i = 0; i < numSynthetiques; i++)
+    {
+        Vertex *v;
+        Face *f;
+        int numV, numF;
+        char nom[64];
+        snprintf(nom, sizeof(nom), "grille-%dx%d", synthetiques[i], synthetiques[i]);
+        maillageSynthetique(synthetiques[i], &v, &numV, &f, &numF);
+        mesurerMaillage(nom, v, numF, f, choisis, numChoisis, repetitions, echauffement, maxQuadratique, &mesures,
+                        &numMesures, &capMesures);
+        free(v);
+        free(f);
+    }
+
+    for (int i = 0; i < numMesures; i++)
+    {
+        if (strcmp(mesures[i].statut, "different") == 0)
+            erreur = 1;
+    }
+
+    if (json != NULL)
+    {
+        FILE *out = fopen(json, "w");
+        if (out == NULL)
+            erreur = 1;
+        else
+        {
+            fprintf(out, "{\n  \"threads\": %d,\n  \"repetitions\": %d,\n  \"echauffement\": %d,\n  \"resultats\": [\n",
+                    nbThreads, repetitions, echauffement);
+            for (int i = 0; i < numMesures; i++)
+            {
+                MesureBanc *r = &mesures[i];
+                fprintf(out, "    {\"maillage\": ");
+                ecrireChaineJSON(out, r->maillage);
+                fprintf(out, ", \"faces\": %d, \"aretes\": %d, \"moteur\": \"%s\", \"statut\": \"%s\"", r->numF,
+                        r->numA, r->moteur, r->statut);
+                if (r->nbMesures > 0)
+                    fprintf(out, ", \"mesures\": %d, \"mediane_s\": %.9f, \"p95_s\": %.9f, \"min_s\": %.9f, \"identique\": %s",
+                            r->nbMesures, r->mediane, r->p95, r->min, r->identique ? "true" : "false");
+                fprintf(out, "}%s\n", i + 1 < numMesures ? "," : "");
+            }
+            fprintf(out, "  ]\n}\n");
+            fclose(out);
+        }
+    }
+    if (csv != NULL)
+    {
+        FILE *out = fopen(csv, "w");
+        if (out == NULL)
+            erreur = 1;
+        else
+        {
+            fprintf(out, "maillage,faces,aretes,moteur,statut,mesures,mediane_s,p95_s,min_s,identique\n");
+            for (int i = 0; i < numMesures; i++)
+            {
+                MesureBanc *r = &mesures[i];
+                ecrireChampCSV(out, r->maillage);
+                fprintf(out, ",%d,%d,%s,%s,%d,%.9f,%.9f,%.9f,%d\n", r->numF, r->numA, r->moteur, r->statut, r->nbMesures,
+                        r->mediane, r->p95, r->min, r->identique);
+            }
+            fclose(out);
+        }
+    }
+
+    free(mesures);
+    free(synthetiques);
+    free(choisis);
+    free(fichiers);
+    return erreur ? 1 : 0;
+}
+
+
+// serveur de distances
+
+/*
+ * Protocole binaire sur socket Unix, entiers 32 bits petit-boutistes. Chaque requête est un
+ * RequeteServeur ; chaque réponse un ReponseServeur suivi de n entiers. Les faces sont
+ * numérotées à partir de 1, comme pour --graines.
+ *
+ *   REQ_INFO       -> nombre de faces de chaque maillage chargé
+ *   REQ_DISTANCES  a = face k          -> distance de chaque face à k (-1 : inaccessible)
+ *   REQ_DISTANCE   a = i, b = j        -> distance entre i et j
+ *   REQ_RAYON      a = face k, b = r   -> faces à distance au plus r de k
+ *   REQ_STATS      -> requêtes, succès et défauts du cache, centiles 50 90 99 99.9 et max (µs)
+ *   REQ_ARRET      -> arrête le serveur
+ */
+#define REQ_INFO 0
+#define REQ_DISTANCES 1
+#define REQ_DISTANCE 2
+#define REQ_RAYON 3
+#define REQ_STATS 4
+#define REQ_ARRET 5
+
+#define STATUT_OK 0
+#define STATUT_REQUETE -1       //Type de requête inconnu
+#define STATUT_MAILLAGE -2      //Maillage inconnu
+#define STATUT_FACE -3          //Face hors du maillage
+
+#define LATENCES_MAX 65536      //Latences gardées pour les centiles (les plus récentes)
+
+typedef struct requeteServeur
+{
+    uint32_t type;
+    uint32_t maillage;      //Indice du maillage, dans l'ordre de la ligne de commande
+    int32_t a, b;
+} RequeteServeur;
+
+typedef struct reponseServeur
+{
+    int32_t statut;
+    uint32_t n;             //Entiers qui suivent
+} ReponseServeur;
+
+/**
+ * @brief   Champ de distances gardé dans le cache LRU. Un champ sorti du cache pendant qu'une
+ *          connexion le lit est libéré par la dernière connexion qui le rend.
+ */
+typedef struct champDistances
+{
+    uint32_t maillage;
+    int source;
+    int *distance;
+    int refs;               //Connexions qui l'utilisent
+    int enCache;
+    long long usage;        //Horloge du dernier accès (LRU)
+} ChampDistances;
+
+typedef struct serveurDistances
+{
+    int numMaillages;
+    DualCSR **graphes;      //Graphe dual résident de chaque maillage
+    int maxFaces;
+    ChampDistances **champs;
+    int capacite, numChamps;
+    long long horloge, succes, defauts;
+    double *latences;       //Tampon circulaire (µs)
+    long long numRequetes;
+    int ecoute;             //Socket d'écoute
+    int arret;
+    int connexions;         //Connexions en cours
+    int *ouvertes, capOuvertes;     //Descripteurs des connexions en cours, fermés en lecture à l'arrêt
+    pthread_mutex_t verrou;
+    pthread_cond_t fin;     //Signalé quand une connexion se termine
+} ServeurDistances;
+
+typedef struct connexionServeur
+{
+    ServeurDistances *s;
+    int fd;
+} ConnexionServeur;
+
+
+static int lireToutFd(int fd, void *data, size_t taille)
+{
+    char *p = data;
+    while (taille > 0)
+    {
+        ssize_t n = read(fd, p, taille);
+        if (n <= 0)
+            return 0;
+        p += n;
+        taille -= n;
+    }
+    return 1;
+}
+
+/**
+ * @brief   Centile au plus proche rang, comme le p95 du banc d'essai
+ * @param   t           Valeurs, triées par la fonction
+ * @param   n           Nombre de valeurs
+ * @param   pourMille   Centile en pour mille (500 : médiane, 999 : 99,9 %)
+ */
+static double centile(double *t, int n, int pourMille)
+{
+    if (n == 0)
+        return 0;
+    qsort(t, n, sizeof(double), comparerDouble);
+    return t[max((int)(((long long)n * pourMille + 999) / 1000) - 1, 0)];
+}
+
+
+/**
+ * @brief   Charge un maillage et construit son graphe dual avec le moteur choisi
+ * @return  Graphe dual (à libérer avec libererCSR), NULL si la lecture échoue
+ */
+DualCSR *chargerDual(const char *chemin, Moteur *moteur)
+{
+    Vertex *v;
+    Face *f;
+    int numV, numF;
+    if (!readObjMmap(chemin, &v, &numV, &f, &numF))
+        return NULL;
+    SommetsSoA soa = sommetsSoA(v, numV);
+    Centoide *c;
+    Arete *a;
+    passeFaces(&soa, f, numF, &c, &a);
+    PairesD paires = {NULL, 0, 0};
+    reserverPaires(&paires, 3 * numF);
+    moteur->tri(a, 3 * numF, &paires);
+    DualCSR *g = construireCSR(&paires, numF);
+    libererPaires(&paires);
+    libererSoA(&soa);
+    free(v);
+    free(f);
+    free(c);
+    free(a);
+    return g;
+}
+
+
+/**
+ * @brief   Champ de distances depuis source, pris dans le cache ou calculé (hors verrou) puis
+ *          ajouté au cache à la place du moins récemment utilisé. À rendre avec rendreChamp.
+ */
+static ChampDistances *obtenirChamp(ServeurDistances *s, uint32_t m, int source, int *file)
+{
+    pthread_mutex_lock(&s->verrou);
+    for (int i = 0; i < s->numChamps; i++)
+    {
+        ChampDistances *c = s->champs[i];
+        if (c->maillage == m && c->source == source)
+        {
+            c->refs++;
+            c->usage = ++s->horloge;
+            s->succes++;
+            pthread_mutex_unlock(&s->verrou);
+            return c;
+        }
+    }
+    s->defauts++;
+    pthread_mutex_unlock(&s->verrou);
+
+    ChampDistances *c = malloc(sizeof(ChampDistances));
+    c->maillage = m;
+    c->source = source;
+    c->distance = malloc(sizeof(int) * max(s->graphes[m]->numF, 1));
+    c->refs = 1;
+    c->enCache = 1;
+    bfsSource(s->graphes[m], source, c->distance, file);
+
+    pthread_mutex_lock(&s->verrou);
+    for (int i = 0; i < s->numChamps; i++)    //Une autre connexion a pu calculer le même champ entre-temps
+    {
+        ChampDistances *deja = s->champs[i];
+        if (deja->maillage == m && deja->source == source)
+        {
+            deja->refs++;
+            deja->usage = ++s->horloge;
+            pthread_mutex_unlock(&s->verrou);
+            free(c->distance);
+            free(c);
+            return deja;
+        }
+    }
+    c->usage = ++s->horloge;
+    int place = s->numChamps;
+    if (s->numChamps == s->capacite)
+    {
+        place = 0;
+        for (int i = 1; i < s->numChamps; i++)
+            if (s->champs[i]->usage < s->champs[place]->usage)
+                place = i;
+        ChampDistances *vieux = s->champs[place];
+        vieux->enCache = 0;
+        if (vieux->refs == 0)
+        {
+            free(vieux->distance);
+            free(vieux);
+        }
+    }
+    else
+        s->numChamps++;
+    s->champs[place] = c;
+    pthread_mutex_unlock(&s->verrou);
+    return c;
+}
+
+static void rendreChamp(ServeurDistances *s, ChampDistances *c)
+{
+    pthread_mutex_lock(&s->verrou);
+    if (--c->refs == 0 && !c->enCache)
+    {
+        free(c->distance);
+        free(c);
+    }
+    pthread_mutex_unlock(&s->verrou);
+}
+
+
+/**
+ * @brief   Requêtes, cache et centiles de latence (8 entiers, voir REQ_STATS)
+ */
+static void statsServeur(ServeurDistances *s, int32_t *stats)
+{
+    pthread_mutex_lock(&s->verrou);
+    int n = (int)min(s->numRequetes, (long long)LATENCES_MAX);
+    double *t = malloc(sizeof(double) * max(n, 1));
+    memcpy(t, s->latences, sizeof(double) * n);
+    stats[0] = (int32_t)s->numRequetes;
+    stats[1] = (int32_t)s->succes;
+    stats[2] = (int32_t)s->defauts;
+    pthread_mutex_unlock(&s->verrou);
+    static const int rangs[5] = {500, 900, 990, 999, 1000};
+    for (int k = 0; k < 5; k++)
+        stats[3 + k] = (int32_t)(centile(t, n, rangs[k]) + 0.5);
+    free(t);
+}
+
+
+/**
+ * @brief   Répond à une requête
+ * @param   donnees     Tampon d'au moins max(maxFaces, numMaillages) + 8 entiers pour la réponse
+ * @param   file        File du parcours en largeur, au moins maxFaces entiers
+ */
+static ReponseServeur repondre(ServeurDistances *s, RequeteServeur *q, int32_t *donnees, int *file)
+{
+    ReponseServeur r = {STATUT_OK, 0};
+    if (q->type == REQ_INFO)
+    {
+        r.n = s->numMaillages;
+        for (int m = 0; m < s->numMaillages; m++)
+            donnees[m] = s->graphes[m]->numF;
+        return r;
+    }
+    if (q->type == REQ_STATS)
+    {
+        r.n = 8;
+        statsServeur(s, donnees);
+        return r;
+    }
+    if (q->type == REQ_ARRET)
+    {
+        pthread_mutex_lock(&s->verrou);
+        s->arret = 1;
+        for (int k = 0; k < s->connexions; k++)    //Débloque les connexions inactives, les réponses partent encore
+            shutdown(s->ouvertes[k], SHUT_RD);
+        pthread_mutex_unlock(&s->verrou);
+        shutdown(s->ecoute, SHUT_RDWR);     //Débloque accept
+        return r;
+    }
+    if (q->type != REQ_DISTANCES && q->type != REQ_DISTANCE && q->type != REQ_RAYON)
+    {
+        r.statut = STATUT_REQUETE;
+        return r;
+    }
+    if (q->maillage >= (uint32_t)s->numMaillages)
+    {
+        r.statut = STATUT_MAILLAGE;
+        return r;
+    }
+    DualCSR *g = s->graphes[q->maillage];
+    if (q->a < 1 || q->a > g->numF || (q->type == REQ_DISTANCE && (q->b < 1 || q->b > g->numF)))
+    {
+        r.statut = STATUT_FACE;
+        return r;
+    }
+
+    ChampDistances *c = obtenirChamp(s, q->maillage, q->a - 1, file);
+    if (q->type == REQ_DISTANCES)
+    {
+        r.n = g->numF;
+        memcpy(donnees, c->distance, sizeof(int32_t) * g->numF);
+    }
+    else if (q->type == REQ_DISTANCE)
+    {
+        r.n = 1;
+        donnees[0] = c->distance[q->b - 1];
+    }
+    else
+    {
+        for (int f = 0; f < g->numF; f++)
+            if (c->distance[f] >= 0 && c->distance[f] <= q->b)
+                donnees[r.n++] = f + 1;
+    }
+    rendreChamp(s, c);
+    return r;
+}
+
+
+void *travailConnexion(void *arg)
+{
+    ConnexionServeur *cx = arg;
+    ServeurDistances *s = cx->s;
+    int32_t *donnees = malloc(sizeof(int32_t) * (max(s->maxFaces, s->numMaillages) + 8));
+    int *file = malloc(sizeof(int) * max(s->maxFaces, 1));
+    RequeteServeur q;
+    while (lireToutFd(cx->fd, &q, sizeof(q)))
+    {
+        double debut = tempsMur();
+        ReponseServeur r = repondre(s, &q, donnees, file);
+        if (!ecrireTout(cx->fd, (const char *)&r, sizeof(r)) ||
+            !ecrireTout(cx->fd, (const char *)donnees, sizeof(int32_t) * r.n))
+            break;
+        double latence = (tempsMur() - debut) * 1e6;
+        pthread_mutex_lock(&s->verrou);
+        s->latences[s->numRequetes++ % LATENCES_MAX] = latence;
+        pthread_mutex_unlock(&s->verrou);
+    }
+    free(donnees);
+    free(file);
+
+    pthread_mutex_lock(&s->verrou);
+    for (int k = 0; k < s->connexions; k++)     //Retirée avant close : le numéro peut resservir
+    {
+        if (s->ouvertes[k] == cx->fd)
+        {
+            s->ouvertes[k] = s->ouvertes[--s->connexions];
+            break;
+        }
+    }
+    close(cx->fd);
+    pthread_cond_broadcast(&s->fin);
+    pthread_mutex_unlock(&s->verrou);
+    free(cx);
+    return NULL;
+}
+
+
+static int adresseSocket(const char *chemin, struct sockaddr_un *adr)
+{
+    memset(adr, 0, sizeof(*adr));
+    adr->sun_family = AF_UNIX;
+    if (strlen(chemin) >= sizeof(adr->sun_path))
+    {
+        printf("Chemin de socket trop long : %s\n", chemin);
+        return 0;
+    }
+    strcpy(adr->sun_path, chemin);
+    return 1;
+}
+
+
+/**
+ * @brief   Mode --serveur : charge les maillages une fois, garde leurs graphes duals en
+ *          mémoire et répond aux requêtes (une connexion par thread) jusqu'à REQ_ARRET.
+ *
+ * Options (après --serveur) : --champs N, taille du cache LRU des champs de distances
+ * (défaut 64). Puis le chemin de la socket et les maillages.
+ *
+ * @return  1 si le serveur s'est arrêté normalement, 0 sinon
+ */
+int serveur(int argc, char **argv, Moteur *moteur)
+{
+    int capacite = 64;
+    int i = 0;
+    while (i < argc && strcmp(argv[i], "--champs") == 0 && i + 1 < argc)
+    {
+        capacite = max(1, atoi(argv[i + 1]));
+        i += 2;
+    }
+    if (argc - i < 2)
+    {
+        printf("Utilisation : --serveur [--champs N] socket maillage.obj...\n");
+        return 0;
+    }
+    const char *chemin = argv[i++];
+
+    ServeurDistances s;
+    memset(&s, 0, sizeof(s));
+    s.numMaillages = argc - i;
+    s.graphes = malloc(sizeof(DualCSR *) * s.numMaillages);
+    s.capacite = capacite;
+    s.champs = malloc(sizeof(ChampDistances *) * capacite);
+    s.latences = malloc(sizeof(double) * LATENCES_MAX);
+    pthread_mutex_init(&s.verrou, NULL);
+    pthread_cond_init(&s.fin, NULL);
+
+    int ok = 1;
+    for (int m = 0; m < s.numMaillages; m++)
+    {
+        double debut = tempsMur();
+        s.graphes[m] = chargerDual(argv[i + m], moteur);
+        if (s.graphes[m] == NULL)
+        {
+            printf("Impossible de charger %s\n", argv[i + m]);
+            s.numMaillages = m;
+            ok = 0;
+            break;
+        }
+        s.maxFaces = max(s.maxFaces, s.graphes[m]->numF);
+        printf("Maillage %d : %s, %d faces, graphe dual en %f s\n", m, argv[i + m], s.graphes[m]->numF,
+               tempsMur() - debut);
+    }
+
+    struct sockaddr_un adr;
+    if (ok && !adresseSocket(chemin, &adr))
+        ok = 0;
+    if (ok)
+    {
+        struct stat st;
+        if (lstat(chemin, &st) == 0)
+        {
+            if (!S_ISSOCK(st.st_mode))    //Seule une ancienne socket est remplacée
+            {
+                printf("%s existe et n'est pas une socket : refus de l'écraser\n", chemin);
+                ok = 0;
+            }
+            else
+                unlink(chemin);
+        }
+    }
+    if (ok)
+    {
+        s.ecoute = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (s.ecoute < 0 || bind(s.ecoute, (struct sockaddr *)&adr, sizeof(adr)) != 0 || listen(s.ecoute, 64) != 0)
+        {
+            printf("Impossible d'écouter sur %s\n", chemin);
+            ok = 0;
+        }
+    }
+
+    if (ok)
+    {
+        signal(SIGPIPE, SIG_IGN);   //Un client parti ne doit pas arrêter le serveur
+        printf("Serveur prêt sur %s (cache de %d champs)\n", chemin, capacite);
+        fflush(stdout);
+        for (;;)
+        {
+            int fd = accept(s.ecoute, NULL, NULL);
+            pthread_mutex_lock(&s.verrou);    //Arrêt et liste des connexions sous le même verrou
+            if (s.arret)
+            {
+                pthread_mutex_unlock(&s.verrou);
+                if (fd >= 0)
+                    close(fd);
+                break;
+            }
+            if (fd < 0)
+            {
+                pthread_mutex_unlock(&s.verrou);
+                continue;
+            }
+            if (s.connexions == s.capOuvertes)
+            {
+                s.capOuvertes = max(16, 2 * s.capOuvertes);
+                s.ouvertes = realloc(s.ouvertes, sizeof(int) * s.capOuvertes);
+            }
+            s.ouvertes[s.connexions++] = fd;
+            pthread_mutex_unlock(&s.verrou);
+
+            ConnexionServeur *cx = malloc(sizeof(ConnexionServeur));
+            cx->s = &s;
+            cx->fd = fd;
+            pthread_t t;
+            pthread_create(&t, NULL, travailConnexion, cx);
+            pthread_detach(t);
+        }
+
+        pthread_mutex_lock(&s.verrou);
+        while (s.connexions > 0)
+            pthread_cond_wait(&s.fin, &s.verrou);
+        pthread_mutex_unlock(&s.verrou);
+
+        int32_t stats[8];
+        statsServeur(&s, stats);
+        printf("Serveur arrêté : %d requêtes, cache %d succès / %d défauts\n", stats[0], stats[1], stats[2]);
+        printf("Latence (µs) : p50 %d  p90 %d  p99 %d  p99.9 %d  max %d\n", stats[3], stats[4], stats[5], stats[6],
+               stats[7]);
+    }
+    if (s.ecoute > 0)
+    {
+        close(s.ecoute);
+        unlink(chemin);
+    }
+
+    for (int k = 0; k < s.numChamps; k++)
+    {
+        free(s.champs[k]->distance);
+        free(s.champs[k]);
+    }
+    for (int m = 0; m < s.numMaillages; m++)
+        libererCSR(s.graphes[m]);
+    free(s.graphes);
+    free(s.champs);
+    free(s.latences);
+    free(s.ouvertes);
+    pthread_mutex_destroy(&s.verrou);
+    pthread_cond_destroy(&s.fin);
+    return ok;
+}
+
+
+// client et générateur de charge
+
+static int connecterServeur(const char *chemin)
+{
+    struct sockaddr_un adr;
+    if (!adresseSocket(chemin, &adr))
+        return -1;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, (struct sockaddr *)&adr, sizeof(adr)) != 0)
+    {
+        close(fd);
+        fd = -1;
     }
-    a = realloc(a, sizeof(Arete) * tmp);
-    *numA = tmp;
-    return a;
+    if (fd < 0)
+        printf("Impossible de se connecter à %s\n", chemin);
+    return fd;
 }
 
-Vertex *AretetoV(Arete *a, int numA)
+/**
+ * @brief   Envoie une requête et lit la réponse
+ * @param   donnees     Tampon de la réponse, agrandi au besoin
+ * @param   cap         Capacité de *donnees en entiers, mise à jour
+ * @return  1 si l'échange a eu lieu, 0 si la connexion est coupée
+ */
+static int echangerServeur(int fd, RequeteServeur q, ReponseServeur *r, int32_t **donnees, uint32_t *cap)
 {
-    int numV = numA * 2;
-    Vertex *v = malloc(sizeof(Vertex) * numV);
-    int i = 0;
-    int j = 0;
-    while (i < numV)
+    if (!ecrireTout(fd, (const char *)&q, sizeof(q)) || !lireToutFd(fd, r, sizeof(*r)))
+        return 0;
+    if (r->n > *cap)
     {
-        v[i] = a[j].sommet1.centre;
-        i++;
-        v[i] = a[j].sommet2.centre;
-        i++;
-        j++;
+        *cap = r->n;
+        *donnees = realloc(*donnees, sizeof(int32_t) * *cap);
     }
-    return v;
+    return lireToutFd(fd, *donnees, sizeof(int32_t) * r->n);
 }
 
-Face *AretetoF(Arete *a, int numA)
+static const char *texteStatut(int32_t statut)
 {
-    Face *f = malloc(sizeof(Face) * numA);
-    for (int i = 0; i < numA; i++)
+    switch (statut)
     {
-        f[i].v1 = i * 2 + 1;
-        f[i].v2 = i * 2 + 1;
-        f[i].v3 = i * 2 + 2;
+    case STATUT_REQUETE:
+        return "requête inconnue";
+    case STATUT_MAILLAGE:
+        return "maillage inconnu";
+    case STATUT_FACE:
+        return "face hors du maillage";
+    default:
+        return "erreur";
     }
-    return f;
-} */
+}
+
+
+/**
+ * @brief   Mode --client : envoie une requête et affiche la réponse
+ *
+ * Commandes : info, distances k [m], distance i j [m], rayon k r [m], stats, arret
+ * (m : indice du maillage, 0 par défaut).
+ *
+ * @return  1 si la requête a abouti, 0 sinon
+ */
+int client(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        printf("Utilisation : --client socket info | distances k [m] | distance i j [m] | rayon k r [m] | stats | arret\n");
+        return 0;
+    }
+    static const struct
+    {
+        const char *nom;
+        uint32_t type;
+        int numArgs;
+    } commandes[] = {{"info", REQ_INFO, 0},     {"distances", REQ_DISTANCES, 1}, {"distance", REQ_DISTANCE, 2},
+                     {"rayon", REQ_RAYON, 2}, {"stats", REQ_STATS, 0},         {"arret", REQ_ARRET, 0}};
+    int c = -1;
+    for (int k = 0; k < (int)(sizeof(commandes) / sizeof(commandes[0])); k++)
+        if (strcmp(argv[1], commandes[k].nom) == 0)
+            c = k;
+    if (c < 0 || argc < 2 + commandes[c].numArgs)
+    {
+        printf("Commande invalide : %s\n", argv[1]);
+        return 0;
+    }
+    RequeteServeur q = {commandes[c].type, 0, 0, 0};
+    if (commandes[c].numArgs >= 1)
+        q.a = atoi(argv[2]);
+    if (commandes[c].numArgs >= 2)
+        q.b = atoi(argv[3]);
+    if (argc > 2 + commandes[c].numArgs)
+        q.maillage = atoi(argv[2 + commandes[c].numArgs]);
+
+    int fd = connecterServeur(argv[0]);
+    if (fd < 0)
+        return 0;
+    ReponseServeur r;
+    int32_t *donnees = NULL;
+    uint32_t cap = 0;
+    double debut = tempsMur();
+    int ok = echangerServeur(fd, q, &r, &donnees, &cap);
+    double latence = tempsMur() - debut;
+    close(fd);
+    if (!ok)
+        printf("Connexion coupée\n");
+    else if (r.statut != STATUT_OK)
+    {
+        printf("Erreur : %s\n", texteStatut(r.statut));
+        ok = 0;
+    }
+    else if (q.type == REQ_STATS)
+    {
+        printf("Requêtes : %d, cache : %d succès / %d défauts\n", donnees[0], donnees[1], donnees[2]);
+        printf("Latence (µs) : p50 %d  p90 %d  p99 %d  p99.9 %d  max %d\n", donnees[3], donnees[4], donnees[5],
+               donnees[6], donnees[7]);
+    }
+    else if (q.type == REQ_INFO)
+    {
+        for (uint32_t m = 0; m < r.n; m++)
+            printf("Maillage %u : %d faces\n", m, donnees[m]);
+    }
+    else if (q.type == REQ_DISTANCE)
+        printf("%d\n", donnees[0]);
+    else if (q.type == REQ_DISTANCES || q.type == REQ_RAYON)
+    {
+        for (uint32_t k = 0; k < r.n; k++)
+            printf("%d\n", donnees[k]);
+        fprintf(stderr, "%u valeurs en %f s\n", r.n, latence);
+    }
+    free(donnees);
+    return ok;
+}
+
+
+typedef struct contexteCharge
+{
+    const char *chemin;
+    int requetes;           //Par connexion
+    int numF;
+    int chaudes;            //Graines réutilisées (succès du cache attendus)
+    double *latences;       //Toutes les latences (µs), une plage par connexion
+    int erreurs;
+} ContexteCharge;
+
+typedef struct threadCharge
+{
+    ContexteCharge *ctx;
+    int id;
+} ThreadCharge;
+
+void *travailCharge(void *arg)
+{
+    ThreadCharge *t = arg;
+    ContexteCharge *ctx = t->ctx;
+    unsigned int graine = 12345 + t->id;
+    int fd = connecterServeur(ctx->chemin);
+    int32_t *donnees = NULL;
+    uint32_t cap = 0;
+    int erreurs = 0;
+    for (int k = 0; k < ctx->requetes; k++)
+    {
+        //Mélange : distances entre faces (graines chaudes), champs complets, voisinages
+        int tirage = rand_r(&graine) % 100;
+        int chaude = 1 + (rand_r(&graine) % ctx->chaudes) * (ctx->numF / ctx->chaudes);
+        RequeteServeur q = {REQ_DISTANCE, 0, chaude, 1 + rand_r(&graine) % ctx->numF};
+        if (tirage >= 60 && tirage < 85)
+            q = (RequeteServeur){REQ_DISTANCES, 0, 1 + rand_r(&graine) % ctx->numF, 0};
+        else if (tirage >= 85)
+            q = (RequeteServeur){REQ_RAYON, 0, chaude, 5};
+
+        ReponseServeur r;
+        double debut = tempsMur();
+        if (fd < 0 || !echangerServeur(fd, q, &r, &donnees, &cap) || r.statut != STATUT_OK)
+            erreurs++;
+        ctx->latences[(size_t)t->id * ctx->requetes + k] = (tempsMur() - debut) * 1e6;
+    }
+    if (fd >= 0)
+        close(fd);
+    free(donnees);
+    __atomic_fetch_add(&ctx->erreurs, erreurs, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+
+/**
+ * @brief   Mode --charge : générateur de charge. N connexions simultanées envoient chacune un
+ *          mélange de requêtes sur le maillage 0 (60 % distances entre deux faces depuis un petit
+ *          ensemble de graines chaudes, 25 % champs complets depuis une face au hasard, 15 %
+ *          faces à distance au plus 5), puis affiche débit et centiles vus du client et du serveur.
+ *
+ * Arguments : socket requetes_par_connexion connexions [graines_chaudes (défaut 32)]
+ *
+ * @return  1 si toutes les requêtes ont abouti, 0 sinon
+ */
+int charge(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        printf("Utilisation : --charge socket requetes_par_connexion connexions [graines_chaudes]\n");
+        return 0;
+    }
+    ContexteCharge ctx = {argv[0], max(1, atoi(argv[1])), 0, argc > 3 ? max(1, atoi(argv[3])) : 32, NULL, 0};
+    int connexions = max(1, atoi(argv[2]));
+
+    int fd = connecterServeur(ctx.chemin);
+    if (fd < 0)
+        return 0;
+    ReponseServeur r;
+    int32_t *donnees = NULL;
+    uint32_t cap = 0;
+    int ok = echangerServeur(fd, (RequeteServeur){REQ_INFO, 0, 0, 0}, &r, &donnees, &cap) && r.n > 0;
+    close(fd);
+    if (!ok || donnees[0] == 0)
+    {
+        printf("Le serveur n'a pas de maillage utilisable\n");
+        free(donnees);
+        return 0;
+    }
+    ctx.numF = donnees[0];
+    ctx.chaudes = min(ctx.chaudes, ctx.numF);
+    free(donnees);
+
+    size_t total = (size_t)ctx.requetes * connexions;
+    ctx.latences = malloc(sizeof(double) * total);
+    pthread_t *threads = malloc(sizeof(pthread_t) * connexions);
+    ThreadCharge *args = malloc(sizeof(ThreadCharge) * connexions);
+    double debut = tempsMur();
+    for (int t = 0; t < connexions; t++)
+    {
+        args[t] = (ThreadCharge){&ctx, t};
+        pthread_create(&threads[t], NULL, travailCharge, &args[t]);
+    }
+    for (int t = 0; t < connexions; t++)
+        pthread_join(threads[t], NULL);
+    double duree = tempsMur() - debut;
+
+    printf("Charge : %zu requêtes sur %d connexions en %f s (%.0f requêtes/s), %d erreurs\n", total, connexions,
+           duree, total / duree, ctx.erreurs);
+    printf("Latence client (µs) : p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+           centile(ctx.latences, total, 500), centile(ctx.latences, total, 900), centile(ctx.latences, total, 990),
+           centile(ctx.latences, total, 999), centile(ctx.latences, total, 1000));
+    char *stats[] = {(char *)ctx.chemin, "stats"};
+    client(2, stats);
+
+    free(ctx.latences);
+    free(threads);
+    free(args);
+    return ctx.erreurs == 0;
+}
+
+
+/**
+ * @brief   Mesure l'accélération de triParallele pour 1, 2, 4, ..., maxThreads threads.
+ *
+ * Chaque résultat est comparé aux paires de triHash, identiques à celles de triAVL.
+ *
+ * @param   a           Tableau des arêtes
+ * @param   numA        Nombre d'arêtes
+ * @param   maxThreads  Nombre maximal de threads
+ * @return  1 si tous les tableaux de paires sont identiques, 0 sinon
+ */
+int rapportScaling(Arete *a, int numA, int maxThreads)
+{
+    PairesD reference = {NULL, 0, 0}, ad = {NULL, 0, 0};
+    reserverPaires(&reference, numA);
+    triHash(a, numA, &reference);
+    int identiques = 1;
+    double temps1 = 0;
+    int sauve = nbThreads;
+
+    printf("threads   temps (s)   accélération\n");
+    for (int t = 1; t <= maxThreads; t = (t < maxThreads && t * 2 > maxThreads) ? maxThreads : t * 2)
+    {
+        nbThreads = t;
+        double meilleur = 0;
+        for (int essai = 0; essai < 3; essai++)   //On garde le meilleur de trois essais
+        {
+            reserverPaires(&ad, numA);
+            double debut = tempsMur();
+            triParallele(a, numA, &ad);
+            double temps = tempsMur() - debut;
+            if (essai == 0 || temps < meilleur)
+                meilleur = temps;
+            if (!memesPaires(&ad, &reference))
+                identiques = 0;
+        }
+        if (t == 1)
+            temps1 = meilleur;
+        printf("%7d   %9.6f   %12.2f\n", t, meilleur, temps1 / meilleur);
+        if (t == maxThreads)
+            break;
+    }
+    printf("Paires identiques à triAVL : %s\n", identiques ? "oui" : "non");
+
+    nbThreads = sauve;
+    libererPaires(&reference);
+    libererPaires(&ad);
+    return identiques;
+}
+
+
+void usage(const char *prog)
+{
+    printf("Utilisation: %s [options] fichier_entree fichier_sortie\n", prog);
+    printf("       %s --scaling [-j N] fichier_entree\n", prog);
+    printf("       %s --vers-obj sortie.ply|sortie.gdc fichier.obj\n", prog);
+    printf("       %s [-m moteur] [-j N] --lot manifeste [--lot-rapport fichier.csv]\n", prog);
+    printf("       %s [-m moteur] --serveur [--champs N] socket maillage.obj...\n", prog);
+    printf("       %s --client socket info|distances k|distance i j|rayon k r|stats|arret [maillage]\n", prog);
+    printf("       %s --charge socket requetes_par_connexion connexions [graines_chaudes]\n", prog);
+    printf("       %s [-j N] --bench [options] [fichiers.obj...]   (--bench --help pour les options)\n", prog);
+    printf("  -m moteur   moteur d'appariement des arêtes :");
+    for (int i = 0; i < numMoteurs; i++)
+        printf(" %s", moteurs[i].nom);
+    printf(" (défaut avl)\n");
+    printf("  -j N        nombre de threads pour la lecture et le moteur parallele (défaut : un par cœur)\n");
+    printf("  --scaling   mesure l'accélération du moteur parallele de 1 à N threads\n");
+    printf("  --bfs mode  parcours des distances : file (défaut) ou parallele\n");
+    printf("  --geodesique  distances pondérées par la longueur entre centres (Dijkstra, tas radix)\n");
+    printf("  --composantes  parcourt chaque composante connexe depuis sa propre source (en parallèle)\n");
+    printf("              et compte les arêtes de bord et non manifold\n");
+    printf("  --bfs-stats affiche les statistiques par niveau du parcours parallele\n");
+    printf("  --ecriture-async  écrit la sortie depuis un thread d'E/S pendant le formatage\n");
+    printf("  --mem-limit N[K|M|G]  construit le graphe dual hors mémoire (runs triés sur disque) sans dépasser N octets\n");
+    printf("  --cache     garde le maillage et le graphe dual dans fichier_entree.cache pour les exécutions suivantes\n");
+    printf("  --editions fichier  applique des ajouts (+ v1 v2 v3) et retraits (- n) de faces en mettant à jour\n");
+    printf("              le graphe dual et les distances sans tout recalculer\n");
+    printf("  --graines a,b,...|@fichier  distances depuis chaque graine (faces à partir de 1) : un\n");
+    printf("              fichier_sortie_graine<N>.obj par graine, ou la matrice avec --matrice fichier\n");
+    printf("  --multi-bfs mode  noyau de --graines : file (défaut, un parcours par graine) ou bits\n");
+    printf("              (%d graines par parcours, bits parallèles)\n", MS_LOT);
+    printf("  --format obj|ply|gdc  format de sortie : OBJ texte (défaut), PLY binaire (couleurs et arêtes)\n");
+    printf("              ou GDC compressé (voisins en écarts varint, distances sur 16 bits)\n");
+    printf("  --lot manifeste  traite les paires \"entree sortie\" du manifeste (une par ligne) sur N\n");
+    printf("              travailleurs (moteur sur un thread chacun), plus gros maillages d'abord ; --lot-rapport\n");
+    printf("              écrit le détail en CSV\n");
+    printf("  --vers-obj  reconvertit une sortie PLY ou GDC en OBJ identique\n");
+    printf("  --souder eps  fusionne les sommets à moins de eps (grille de hachage parallèle) et retire\n");
+    printf("              les faces devenues dégénérées (listées), avant la génération des arêtes ; --graines\n");
+    printf("              reste dans la numérotation d'origine\n");
+    printf("  --reordonner morton|hilbert  range sommets et faces le long d'une courbe de remplissage\n");
+    printf("              (sorties dans la numérotation d'origine) et compare les défauts de cache\n");
+    printf("  --scalaire  désactive les noyaux SIMD de la passe sur les faces\n");
+    printf("  --profile table|fichier.json  temps mural et CPU, pic RSS et octets alloués, compteurs matériels et algorithmiques par phase\n");
+}
 
 int main(int argc, char *argv[])
 {
-    if (argc != 3)
+    Moteur *moteur = chercherMoteur("avl");
+    int scaling = 0;
+    int versObj = 0;
+    const char *manifeste = NULL;
+    const char *rapportLot = NULL;
+    int avecCache = 0;
+    const char *fichierEditions = NULL;
+    const char *specGraines = NULL;
+    const char *fichierMatrice = NULL;
+    int courbe = -1;    //--reordonner : 0 Morton, 1 Hilbert
+    float epsSoudure = 0;   //--souder : distance de soudure, 0 sans soudure
+    int arg = 1;
+
+    while (arg < argc && argv[arg][0] == '-')
+    {
+        if (strcmp(argv[arg], "-m") == 0 && arg + 1 < argc)
+        {
+            moteur = chercherMoteur(argv[arg + 1]);
+            if (moteur == NULL)
+            {
+                printf("Moteur inconnu: %s\n", argv[arg + 1]);
+                usage(argv[0]);
+                return 1;
+            }
+            arg += 2;
+        }
+        else if (strcmp(argv[arg], "-j") == 0 && arg + 1 < argc)
+        {
+            nbThreads = atoi(argv[arg + 1]);
+            arg += 2;
+        }
+        else if (strcmp(argv[arg], "--bench") == 0)
+        {
+            if (nbThreads <= 0)
+                nbThreads = max(1, (int)sysconf(_SC_NPROCESSORS_ONLN));
+            return banc(argc - arg - 1, argv + arg + 1, argv[0]);
+        }
+        else if (strcmp(argv[arg], "--serveur") == 0)
+        {
+            if (epsSoudure > 0)
+            {
+                printf("--souder et --serveur sont incompatibles (le serveur charge les maillages sans soudure)\n");
+                return 1;
+            }
+            if (nbThreads <= 0)
+                nbThreads = max(1, (int)sysconf(_SC_NPROCESSORS_ONLN));
+            return serveur(argc - arg - 1, argv + arg + 1, moteur) ? 0 : 1;
+        }
+        else if (strcmp(argv[arg], "--client") == 0)
+            return client(argc - arg - 1, argv + arg + 1) ? 0 : 1;
+        else if (strcmp(argv[arg], "--charge") == 0)
+            return charge(argc - arg - 1, argv + arg + 1) ? 0 : 1;
+        else if (strcmp(argv[arg], "--scaling") == 0)
+        {
+            scaling = 1;
+            arg++;
+        }
+        else if (strcmp(argv[arg], "--bfs") == 0 && arg + 1 < argc)
+        {
+            if (strcmp(argv[arg + 1], "parallele") == 0)
+                bfsParallele = 1;
+            else if (strcmp(argv[arg + 1], "file") == 0)
+                bfsParallele = 0;
+            else
+            {
+                printf("Parcours inconnu: %s\n", argv[arg + 1]);
+                usage(argv[0]);
+                return 1;
+            }
+            arg += 2;
+        }
+        else if (strcmp(argv[arg], "--geodesique") == 0)
+        {
+            geodesique = 1;
+            arg++;
+        }
+        else if (strcmp(argv[arg], "--composantes") == 0)
+        {
+            parComposantes = 1;
+            arg++;
+        }
+        else if (strcmp(argv[arg], "--bfs-stats") == 0)
+        {
+            bfsStats = 1;
+            arg++;
+        }
+        else if (strcmp(argv[arg], "--ecriture-async") == 0)
+        {
+            ecritureAsynchrone = 1;
+            arg++;
+        }
+        else if (strcmp(argv[arg], "--mem-limit") == 0 && arg + 1 < argc)
+        {
+            char *fin;
+            limiteMemoire = strtoll(argv[arg + 1], &fin, 10);
+            if (*fin == 'K' || *fin == 'k')
+                limiteMemoire <<= 10;
+            else if (*fin == 'M' || *fin == 'm')
+                limiteMemoire <<= 20;
+            else if (*fin == 'G' || *fin == 'g')
+                limiteMemoire <<= 30;
+            if (limiteMemoire < (1 << 20))
+            {
+                printf("Limite mémoire trop petite (au moins 1M)\n");
+                return 1;
+            }
+            arg += 2;
+        }
+        else if (strcmp(argv[arg], "--cache") == 0)
+        {
+            avecCache = 1;
+            arg++;
+        }
+        else if (strcmp(argv[arg], "--editions") == 0 && arg + 1 < argc)
+        {
+            fichierEditions = argv[arg + 1];
+            arg += 2;
+        }
+        else if (strcmp(argv[arg], "--graines") == 0 && arg + 1 < argc)
+        {
+            specGraines = argv[arg + 1];
+            arg += 2;
+        }
+        else if (strcmp(argv[arg], "--multi-bfs") == 0 && arg + 1 < argc)
+        {
+            if (strcmp(argv[arg + 1], "bits") == 0)
+                msBits = 1;
+            else if (strcmp(argv[arg + 1], "file") == 0)
+                msBits = 0;
+            else
+            {
+                printf("Parcours multi-sources inconnu: %s\n", argv[arg + 1]);
+                usage(argv[0]);
+                return 1;
+            }
+            arg += 2;
+        }
+        else if (strcmp(argv[arg], "--matrice") == 0 && arg + 1 < argc)
+        {
+            fichierMatrice = argv[arg + 1];
+            arg += 2;
+        }
+        else if (strcmp(argv[arg], "--format") == 0 && arg + 1 < argc)
+        {
+            if (strcmp(argv[arg + 1], "obj") == 0)
+                formatSortie = FORMAT_OBJ;
+            else if (strcmp(argv[arg + 1], "ply") == 0)
+                formatSortie = FORMAT_PLY;
+            else if (strcmp(argv[arg + 1], "gdc") == 0)
+                formatSortie = FORMAT_GDC;
+            else
+            {
+                printf("Format inconnu: %s\n", argv[arg + 1]);
+                usage(argv[0]);
+                return 1;
+            }
+            arg += 2;
+        }
+        else if (strcmp(argv[arg], "--lot") == 0 && arg + 1 < argc)
+        {
+            manifeste = argv[arg + 1];
+            arg += 2;
+        }
+        else if (strcmp(argv[arg], "--lot-rapport") == 0 && arg + 1 < argc)
+        {
+            rapportLot = argv[arg + 1];
+            arg += 2;
+        }
+        else if (strcmp(argv[arg], "--vers-obj") == 0)
+        {
+            versObj = 1;
+            arg++;
+        }
+        else if (strcmp(argv[arg], "--souder") == 0 && arg + 1 < argc)
+        {
+            epsSoudure = strtof(argv[arg + 1], NULL);
+            if (!(epsSoudure > 0))
+            {
+                printf("Distance de soudure invalide: %s\n", argv[arg + 1]);
+                return 1;
+            }
+            arg += 2;
+        }
+        else if (strcmp(argv[arg], "--reordonner") == 0 && arg + 1 < argc)
+        {
+            if (strcmp(argv[arg + 1], "morton") == 0)
+                courbe = 0;
+            else if (strcmp(argv[arg + 1], "hilbert") == 0)
+                courbe = 1;
+            else
+            {
+                printf("Courbe inconnue: %s\n", argv[arg + 1]);
+                usage(argv[0]);
+                return 1;
+            }
+            arg += 2;
+        }
+        else if (strcmp(argv[arg], "--scalaire") == 0)
+        {
+            forcerScalaire = 1;
+            arg++;
+        }
+        else if (strcmp(argv[arg], "--profile") == 0 && arg + 1 < argc)
+        {
+            profilage = 1;
+            if (strcmp(argv[arg + 1], "table") != 0)
+                profilSortie = argv[arg + 1];
+            arg += 2;
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (argc - arg != (manifeste ? 0 : scaling ? 1 : 2))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    if (nbThreads <= 0)
+        nbThreads = max(1, (int)sysconf(_SC_NPROCESSORS_ONLN));
+    if (courbe >= 0 && avecCache)
+    {
+        printf("--reordonner et --cache sont incompatibles (le cache garde l'ordre du fichier)\n");
+        return 1;
+    }
+    if (epsSoudure > 0 && avecCache)
+    {
+        printf("--souder et --cache sont incompatibles (le cache garde le maillage du fichier)\n");
+        return 1;
+    }
+    if (limiteMemoire > 0 && !scaling)
+    {
+        const char *ignoree = geodesique ? "--geodesique" : courbe >= 0 ? "--reordonner"
+                            : specGraines != NULL ? "--graines" : fichierEditions != NULL ? "--editions"
+                            : parComposantes ? "--composantes" : bfsParallele ? "--bfs parallele"
+                            : avecCache ? "--cache" : NULL;
+        if (ignoree != NULL)
+        {
+            printf("%s et --mem-limit sont incompatibles (un parcours en largeur simple depuis la graine par "
+                   "défaut)\n", ignoree);
+            return 1;
+        }
+    }
+    if (fichierEditions != NULL)
+    {
+        const char *ignoree = geodesique ? "--geodesique" : specGraines != NULL ? "--graines"
+                            : courbe >= 0 ? "--reordonner" : parComposantes ? "--composantes"
+                            : bfsParallele ? "--bfs parallele" : NULL;
+        if (ignoree != NULL)
+        {
+            printf("%s et --editions sont incompatibles (distances en sauts depuis la graine par défaut, "
+                   "réparées à chaque édition)\n", ignoree);
+            return 1;
+        }
+    }
+    if (epsSoudure > 0 && (limiteMemoire > 0 || fichierEditions != NULL))
+    {
+        printf("--souder et %s sont incompatibles (le maillage y est lu sans soudure)\n",
+               limiteMemoire > 0 ? "--mem-limit" : "--editions");
+        return 1;
+    }
+    if (formatSortie != FORMAT_OBJ && limiteMemoire > 0 && !scaling)
     {
-        printf("Utilisation: %s fichier_entree fichier_sortie\n", argv[0]);
+        printf("--format ply|gdc et --mem-limit sont incompatibles (la sortie hors mémoire est en OBJ)\n");
         return 1;
     }
 
-    const char *file = argv[1];
-    const char *fileDst = argv[2];
+    if (manifeste != NULL)
+    {
+        const char *ignoree = parComposantes ? "--composantes" : bfsParallele ? "--bfs parallele"
+                            : courbe >= 0 ? "--reordonner" : epsSoudure > 0 ? "--souder"
+                            : specGraines != NULL ? "--graines" : limiteMemoire > 0 ? "--mem-limit"
+                            : avecCache ? "--cache" : fichierEditions != NULL ? "--editions" : NULL;
+        if (ignoree != NULL)
+        {
+            printf("%s et --lot sont incompatibles (un parcours simple par maillage du manifeste)\n", ignoree);
+            return 1;
+        }
+        return traiterLot(manifeste, moteur, rapportLot) ? 0 : 1;
+    }
+
+    const char *file = argv[arg];
+    const char *fileDst = argv[arg + 1];
+    if (versObj)
+        return convertirVersObj(file, fileDst) ? 0 : 1;
+    int *graines = NULL;
+    int numGraines = 0;
+    if (specGraines != NULL && (graines = lireGraines(specGraines, &numGraines)) == NULL)
+        return 1;
+
+    if (limiteMemoire > 0 && !scaling)
+        return traiterHorsMemoire(file, fileDst, limiteMemoire) ? 0 : 1;
+
     int numV;      //Nombres des sommets
     int numF;      //Nombres des faces
     Vertex *v;     //Tableau des sommets
     Face *f;       //Tableau des faces
     Arete *a;      //Tableau des arêtes
     int numA;      //Aombres des arêtes
-    AreteD *ad;    //Tableau des arêtes dual
+    PairesD ad = {NULL, 0, 0};    //Tableau des arêtes dual
+    DualCSR *g;    //Graphe dual
     Centoide *c;   //Tableau des centoide
+    Cache cache;   //Cache binaire projeté en mémoire
+    char cheminCache[4096];
+    int depuisCache = 0;
 
-    if (readObj(file, &v, &numV, &f, &numF))
+    if (profilage)
+        ouvrirCompteursMateriels();
+
+    snprintf(cheminCache, sizeof(cheminCache), "%s.cache", file);
+    int phase = debutPhase("lecture");
+    if (avecCache && chargerCache(cheminCache, file, moteur->nom, &cache))
+    {
+        depuisCache = 1;
+        v = cache.v;
+        f = cache.f;
+        numV = cache.numV;
+        numF = cache.numF;
+        printf("Lecture du cache %s\n", cheminCache);
+    }
+    else if (readObjMmap(file, &v, &numV, &f, &numF))
     {
         printf("Lecture réussie du fichier .obj\n");
     }
@@ -844,23 +8822,171 @@ int main(int argc, char *argv[])
         printf("Erreur lors de la lecture du fichier .obj\n");
         return 1;
     }
+    finPhase(phase);
+
+    //Sans face il n'y a ni centroïde ni graine pour le parcours : même refus que --lot
+    if (numF == 0)
+    {
+        printf("%s : aucune face\n", file);
+        if (depuisCache)
+            munmap(cache.data, cache.taille);
+        else
+        {
+            free(v);
+            free(f);
+        }
+        free(graines);
+        return 1;
+    }
+
+    if (fichierEditions != NULL)
+    {
+        int ok = traiterEditions(fichierEditions, v, numV, f, numF, fileDst);
+        if (depuisCache)
+            munmap(cache.data, cache.taille);
+        else
+        {
+            free(v);
+            free(f);
+        }
+        return ok ? 0 : 1;
+    }
+
+    if (epsSoudure > 0)
+    {
+        phase = debutPhase("soudure");
+        numFacesSoudure = numF;
+        rangSoudure = malloc(sizeof(int) * max(numF, 1));
+        int soude = souderSommets(v, &numV, f, &numF, epsSoudure, rangSoudure);
+        finPhase(phase);
+        if (soude >= 0 && numF == 0)
+            printf("Aucune face après soudure : distance de soudure trop grande\n");
+        if (soude < 0 || numF == 0)
+        {
+            free(v);
+            free(f);
+            free(rangSoudure);
+            free(graines);
+            return 1;
+        }
+    }
+    if (courbe >= 0)
+    {
+        phase = debutPhase("reordre");
+        reordre = reordonnerMaillage(&v, numV, &f, numF, courbe);
+        finPhase(phase);
+    }
 
     numA = numF * 3;
-    a = generalise(f, numF, v);
-    c = calculateCentroids(v, numV, f, numF);
+    a = NULL;
+    if (scaling)
+    {
+        a = generalise(f, numF, v);
+        int ok = rapportScaling(a, numA, nbThreads);
+        if (depuisCache)
+            munmap(cache.data, cache.taille);
+        else
+        {
+            free(v);
+            free(f);
+        }
+        free(a);
+        free(rangSoudure);
+        if (reordre != NULL)
+            libererReordonnancement(reordre);
+        return ok ? 0 : 1;
+    }
+
+    int dualEnCache = depuisCache && cache.dual.debut != NULL;
+    if (dualEnCache)
+    {
+        phase = debutPhase("centroides");
+        c = calculateCentroids(v, numV, f, numF);
+        finPhase(phase);
+    }
+    else
+    {
+        const char *noyau;
+        choisirNoyauFaces(&noyau);
+        if (profilage)
+            printf("Noyau des faces : %s\n", noyau);
+        phase = debutPhase("faces");    //Centroïdes et arêtes en une passe
+        SommetsSoA soa = sommetsSoA(v, numV);
+        passeFaces(&soa, f, numF, &c, &a);
+        libererSoA(&soa);
+        finPhase(phase);
+    }
+
+    double start_time = tempsMur();    //Temps mural : le moteur parallele utilise plusieurs cœurs
+    if (dualEnCache)
+        g = &cache.dual;   //Graphe dual déjà construit, lu directement dans le cache
+    else
+    {
+        if (parComposantes)
+        {
+            GroupesAretes *gr = grouperAretes(a, numA);
+            printf("Arêtes : %d de bord, %d partagées par deux faces, %d non manifold (jusqu'à %d faces)\n", gr->bord,
+                   gr->variete, gr->nonVariete, gr->maxFaces);
+            libererGroupes(gr);
+        }
+        phase = debutPhase("appariement");
+        if (reordre != NULL)
+            a = aretesOrigine(reordre, a, numF);
+        reserverPaires(&ad, numA);   //Suite de k arêtes identiques : k - 1 arêtes duales
+        moteur->tri(a, numA, &ad);
+        finPhase(phase);
+        phase = debutPhase("csr");
+        int graine = ad.num > 0 ? ad.f[2 * (ad.num - 1)] : 1;   //Graine par défaut, numérotation d'origine
+        if (reordre != NULL)
+        {
+            for (size_t k = 0; k < 2 * (size_t)ad.num; k++)
+                ad.f[k] = reordre->rangFaces[ad.f[k]];
+        }
+        g = construireCSR(&ad, numF);
+        if (reordre != NULL && numF > 0)
+            g->graine = reordre->rangFaces[max(graine - 1, 0)] + 1;    //Même face de départ que sans --reordonner
+        printf("Arêtes duales : %d paires, %zu octets\n", ad.num, sizeof(int) * 2 * (size_t)ad.num);
+        libererPaires(&ad);    //Les paires ne servent plus après
+        finPhase(phase);
+    }
+    double time_used = tempsMur() - start_time;
 
-    clock_t start_time = clock();
-    ad = triAVL(a, numA);
-    clock_t end_time = clock();
-    double cpu_time_used = ((double)(end_time - start_time)) / CLOCKS_PER_SEC;
+    printf("Time used: %f s\n", time_used);
+    if (arenaAVL.allocations > 0)
+        printf("Arène AVL : %lld nœuds, %zu octets\n", arenaAVL.allocations, arenaAVL.octets);
 
-    printf("Time used: %f s\n", cpu_time_used);
-    writeObjFile(c, numF, fileDst, ad);
+    if (avecCache && g != &cache.dual)
+    {
+        if (ecrireCache(cheminCache, file, v, numV, f, numF, g, moteur->nom))
+            printf("Cache écrit : %s\n", cheminCache);
+        else
+            printf("Impossible d'écrire le cache %s\n", cheminCache);
+    }
 
-    free(v);
-    free(f);
+    if (reordre != NULL)
+        rapportLocalite(reordre, f, numV, g, max(g->graine - 1, 0));
+
+    int ok = 1;
+    if (graines != NULL)
+        ok = traiterGraines(c, g, graines, numGraines, fileDst, fichierMatrice);
+    else
+        writeObjFile(c, numF, fileDst, g);
+
+    if (g != &cache.dual)
+        libererCSR(g);
+    if (depuisCache)
+        munmap(cache.data, cache.taille);
+    else
+    {
+        free(v);
+        free(f);
+    }
     free(a);
     free(c);
+    free(graines);
+    free(rangSoudure);
+    if (reordre != NULL)
+        libererReordonnancement(reordre);
 
-    return 0;
+    return rapportProfil() && ok ? 0 : 1;
 }